@@ -0,0 +1,60 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of an AdaptiveHCTree.
+ * Encoder and decoder stay in step by rebuilding after the same symbols.
+ */
+#include "AdaptiveHCTree.hpp"
+
+/** Constructor, start with a tree holding only the escape. */
+AdaptiveHCTree::AdaptiveHCTree()
+    : interval(MIN_INTERVAL), untilRebuild(MIN_INTERVAL) {
+    rebuild();
+}
+
+/** Forget every symbol seen, to code a new stream. */
+void AdaptiveHCTree::reset() {
+    freqs.clear();
+    interval = MIN_INTERVAL;
+    untilRebuild = MIN_INTERVAL;
+    rebuild();
+}
+
+/** Count the symbol just coded, rebuilding the tree when due.
+ * @param symbol the symbol coded.
+ */
+void AdaptiveHCTree::update(twoBytes symbol) {
+    freqs[symbol]++;
+    untilRebuild--;
+    if (untilRebuild == 0) {
+        rebuild();
+        if (interval < MAX_INTERVAL) {
+            interval *= 2;
+        }
+        untilRebuild = interval;
+        if (untilRebuild < REBUILD_FACTOR * freqs.size()) {
+            untilRebuild = REBUILD_FACTOR * freqs.size();
+        }
+    }
+}
+
+/** Rebuild the tree from our counts, escaping with the smallest
+ * symbol not yet seen.
+ */
+void AdaptiveHCTree::rebuild() {
+    tree.reset();
+    // Every symbol seen, nothing left to escape.
+    if (freqs.size() == HCTree::TABLE_SIZE) {
+        tree.build(freqs);
+        return;
+    }
+    twoBytes escape = 0;
+    while (freqs.count(escape)) {
+        escape++;
+    }
+    // Escape goes in the tree without being counted as seen.
+    freqs[escape] = 1;
+    tree.build(freqs);
+    freqs.erase(escape);
+    tree.setEscape(escape);
+}
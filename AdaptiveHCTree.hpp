@@ -0,0 +1,78 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing an AdaptiveHCTree.
+ * A one-pass Huffman coder: the encoder and decoder count symbols as they
+ * go and rebuild the same HCTree from those counts, so no tree is written.
+ */
+#ifndef ADAPTIVEHCTREE_HPP
+#define ADAPTIVEHCTREE_HPP
+
+#include "HCTree.hpp"
+
+/** An adaptive Huffman coder over twoBytes symbols.
+ *  Symbols not yet seen are escaped and written raw, as in a sampled tree.
+ *  @tree the tree symbols are currently coded with.
+ *  @freqs how often each symbol has been coded so far.
+ *  @interval how many symbols to code between rebuilds, before
+ *      REBUILD_FACTOR is applied.
+ *  @untilRebuild how many symbols are left before the next rebuild.
+ */
+class AdaptiveHCTree {
+private:
+    HCTree tree;
+    unordered_map<twoBytes, int> freqs;
+    unsigned int interval;
+    unsigned int untilRebuild;
+
+    /** Count the symbol just coded, rebuilding the tree when due.
+     * @param symbol the symbol coded.
+     */
+    void update(twoBytes symbol);
+
+    /** Rebuild the tree from our counts, escaping with the smallest
+     * symbol not yet seen.
+     */
+    void rebuild();
+
+public:
+    /** Symbols coded before the first rebuild, doubled after each one. */
+    const static unsigned int MIN_INTERVAL = 32;
+    /** Most symbols coded between rebuilds, while there are few
+     * different symbols.
+     */
+    const static unsigned int MAX_INTERVAL = 8192;
+    /** At least this many symbols are coded between rebuilds for each
+     * different symbol seen. A rebuild takes time in the number of
+     * different symbols, so this keeps its cost per symbol small however
+     * many there are.
+     */
+    const static unsigned int REBUILD_FACTOR = 4;
+
+    /** Constructor, start with a tree holding only the escape. */
+    AdaptiveHCTree();
+
+    /** Forget every symbol seen, to code a new stream. */
+    void reset();
+
+    /** Write the bits coding the given symbol, then update the tree.
+     *  @param symbol 16 bits to be encoded.
+     *  @param out our output stream.
+     */
+    ALWAYS_INLINE void encode(twoBytes symbol, BitOutputStream& out) {
+        tree.encode(symbol, out);
+        update(symbol);
+    }
+
+    /** Return symbol coded in the next bits, then update the tree.
+     *  @param in our input stream for bits.
+     *  @return symbol of the 16 bits read.
+     */
+    ALWAYS_INLINE twoBytes decode(BitInputStream& in) {
+        twoBytes symbol = tree.decode(in);
+        update(symbol);
+        return symbol;
+    }
+};
+
+#endif // ADAPTIVEHCTREE_HPP
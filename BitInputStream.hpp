@@ -3,31 +3,102 @@
  * cyeh@ucsd.edu
  * Header file representing a BitInputStream.
  * It is instantiated with a node representing the empty string.
- * @buf One byte buffer of bits.
- * @nbits How many bits have been read from buf.
+ * @buf Buffer of bits read from the input stream but not yet taken.
+ * @nbits How many bits are left in buf.
  * @in Reference to the input stream to use.
+ * @ended Whether fill has gone past the end of the input stream.
+ * @numBytes How many bytes fill has added, past the end included.
  */
 #include "HCNode.hpp"
+#include "BitKernel.hpp"
 #include <climits>
 
 class BitInputStream {
 private:
-    byte buf;
+    unsigned long long buf;
     int nbits;
     istream& in;
+    bool ended;
+    unsigned long long numBytes;
 
 public:
     /** Constructor, clear buffer and initialize bit index */
-    BitInputStream(istream & is) : in(is), buf(0), nbits(CHAR_BIT) {}
+    BitInputStream(istream & is)
+        : buf(0), nbits(0), in(is), ended(false), numBytes(0) {}
 
-    /** Fill the buffer, read one byte from the input stream */
-    void fill();
+    /** Add one byte from the input stream to the buffer */
+    ALWAYS_INLINE void fill() {
+        // read one byte from istream to bitwise buffer, above the unread bits.
+        int next = in.get();
+        ended = ended || next == EOF;
+        numBytes++;
+        buf |= (unsigned long long) (byte) next << nbits;
+        nbits += CHAR_BIT;
+    }
+
+    /** Whether a read has needed more bytes than the input stream had.
+     * They read as all ones.
+     * @return true once fill has gone past the end.
+     */
+    bool hitEnd() const {
+        return ended;
+    }
+
+    /** How many bits have been taken, peeked ones not included.
+     * @return the bits.
+     */
+    unsigned long long bitsTaken() const {
+        return numBytes * CHAR_BIT - nbits;
+    }
+
+    /** Read the next count bits, the first one lowest.
+     * Never reads ahead of the byte holding the last bit taken, so at
+     * a byte boundary the input stream can be moved underneath us.
+     * @param count how many, up to 32.
+     * @return the bits.
+     */
+    ALWAYS_INLINE unsigned int readBits(unsigned int count) {
+        unsigned int bits = peekBits(count);
+        skipBits(count);
+        return bits;
+    }
+
+    /** Look at the next count bits without taking them, the first one
+     * lowest. Unlike readBits, this may read ahead of the bits taken,
+     * getting all ones past the end of the input stream.
+     * @param count how many, up to 32.
+     * @return the bits.
+     */
+    ALWAYS_INLINE unsigned int peekBits(unsigned int count) {
+        while (nbits < (int) count) {
+            fill();
+        }
+        return buf & ((1ull << count) - 1);
+    }
+
+    /** Take count bits that peekBits has looked at.
+     * @param count how many, at most the count given to peekBits.
+     */
+    ALWAYS_INLINE void skipBits(unsigned int count) {
+        buf >>= count;
+        nbits -= count;
+    }
 
     /** Read the next bit from the bit buffer.
      * Fill the buffer from the input stream first if needed.
      * @return 1 if the bit read is 1, 0 if bit read is 0.
      */
-    int readBit();
+    ALWAYS_INLINE int readBit() {
+        // Fill bitwise buffer if there are no more unread bits.
+        if (nbits == 0) {
+            fill();
+        }
+        // Get the next unread bit from the bitwise buffer, and return.
+        unsigned int nextBit = buf & 1;
+        buf >>= 1;
+        nbits--;
+        return nextBit;
+    }
 
     /** Read the amount of characters or unique characters
      * from our bit buffer.
@@ -39,10 +110,14 @@ public:
      * from our bit buffer.
      * @return the short given (16) bits
      */
-    twoBytes readShort();
+    ALWAYS_INLINE twoBytes readShort() {
+        return readBits(sizeof(short) * CHAR_BIT);
+    }
 
     /** Read the next byte from the bit buffer.
      * @return the character given (8) bits.
      */
-    byte readByte();
+    ALWAYS_INLINE byte readByte() {
+        return readBits(CHAR_BIT);
+    }
 };
\ No newline at end of file
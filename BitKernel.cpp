@@ -0,0 +1,124 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of the BitKernels.
+ * generic runs anywhere, sse4.2 adds the crc32 instruction, and bmi2 adds
+ * bzhi and shlx for the masks and shifts, for AVX2 era CPUs and later.
+ * The builds themselves are in the files with the loops.
+ */
+#include "BitKernel.hpp"
+
+/** Lookup table for one byte of CRC32C at a time. */
+struct CrcTable {
+    unsigned int entries[256];
+
+    CrcTable() {
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+static const CrcTable TABLE;
+
+/** CRC32C of one more byte, with the lookup table. */
+unsigned int SoftwareCrc::crc8(unsigned int crc, byte symbol) {
+    return (crc >> 8) ^ TABLE.entries[(crc ^ symbol) & 0xFF];
+}
+
+/** CRC32C of two more bytes, the first in the low 8 bits, with the lookup
+ * table.
+ */
+unsigned int SoftwareCrc::crc16(unsigned int crc, twoBytes symbol) {
+    return crc8(crc8(crc, symbol), symbol >> 8);
+}
+
+/** Runs anywhere. */
+static bool always() {
+    return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/** Whether this CPU has SSE4.2. */
+static bool hasSse42() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+/** Whether this CPU has AVX2 and BMI2, which came together. */
+static bool hasBmi2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")
+            && hasSse42();
+}
+#endif
+
+/** Every kernel, worst first. */
+static const BitKernel KERNELS[] = {
+    {"generic", always, BitKernel::GENERIC},
+#if defined(__x86_64__) || defined(__i386__)
+    {"sse4.2", hasSse42, BitKernel::SSE42},
+    {"bmi2", hasBmi2, BitKernel::BMI2},
+#endif
+};
+
+static const int NUM_KERNELS = sizeof(KERNELS) / sizeof(KERNELS[0]);
+
+/** Ask the CPU once for the best kernel it can run.
+ * @return the kernel.
+ */
+static const BitKernel* detect() {
+    const BitKernel* best = &KERNELS[0];
+    for (int i = 1; i < NUM_KERNELS; i++) {
+        if (KERNELS[i].supported()) {
+            best = &KERNELS[i];
+        }
+    }
+    return best;
+}
+
+/** The kernel in use, detected on first use. */
+static const BitKernel*& active() {
+    static const BitKernel* kernel = detect();
+    return kernel;
+}
+
+/** Get the kernel in use, the best this CPU runs unless select()ed.
+ * @return the kernel.
+ */
+const BitKernel& BitKernel::current() {
+    return *active();
+}
+
+/** Use a kernel by name from now on, for benchmarking. Call it before
+ * starting any threads.
+ * @param name the kernel's name.
+ * @return false if there is no such kernel or this CPU can't run it.
+ */
+bool BitKernel::select(const string& name) {
+    for (int i = 0; i < NUM_KERNELS; i++) {
+        if (name == KERNELS[i].name && KERNELS[i].supported()) {
+            active() = &KERNELS[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Get the name of every kernel this CPU runs, best last.
+ * @return the names, separated by spaces.
+ */
+string BitKernel::names() {
+    string names;
+    for (int i = 0; i < NUM_KERNELS; i++) {
+        if (KERNELS[i].supported()) {
+            names += names.empty() ? "" : " ";
+            names += KERNELS[i].name;
+        }
+    }
+    return names;
+}
@@ -0,0 +1,95 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a BitKernel.
+ * Which build of the hot loops to run: encoding, decoding and counting
+ * symbols are each compiled once per kind of CPU, and the best one this
+ * CPU can run is picked on first use. The bit routines they call are
+ * inline, so each build gets its own instructions for them.
+ */
+#ifndef BITKERNEL_HPP
+#define BITKERNEL_HPP
+
+#include <string>
+#include "HCNode.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+/** Build a function for CPUs with SSE4.2. */
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+/** Build a function for CPUs with AVX2 and BMI2, bzhi and shlx. */
+#define TARGET_BMI2 __attribute__((target("avx2,bmi2,sse4.2")))
+#else
+#define TARGET_SSE42
+#define TARGET_BMI2
+#endif
+
+/** Put the body of a hot loop into each build that calls it. */
+#define ALWAYS_INLINE __attribute__((always_inline)) inline
+
+/** One build of the hot loops. Every kernel gives the same results,
+ *  they differ only in the instructions they use.
+ *  @name what to call it, as for --kernel.
+ *  @supported whether this CPU can run it.
+ *  @level which build each loop picks, GENERIC, SSE42 or BMI2.
+ */
+struct BitKernel {
+    const char* name;
+    bool (*supported)();
+    int level;
+
+    /** Portable build. */
+    const static int GENERIC = 0;
+    /** Build with the crc32 instruction. */
+    const static int SSE42 = 1;
+    /** Build with crc32, bzhi and shlx. */
+    const static int BMI2 = 2;
+
+    /** Get the kernel in use, the best this CPU runs unless select()ed.
+     * @return the kernel.
+     */
+    static const BitKernel& current();
+
+    /** Use a kernel by name from now on, for benchmarking. Call it before
+     * starting any threads.
+     * @param name the kernel's name.
+     * @return false if there is no such kernel or this CPU can't run it.
+     */
+    static bool select(const string& name);
+
+    /** Get the name of every kernel this CPU runs, best last.
+     * @return the names, separated by spaces.
+     */
+    static string names();
+};
+
+/** CRC32C a byte or two at a time with a lookup table, for any CPU. */
+struct SoftwareCrc {
+    /** CRC32C of two more bytes, the first in the low 8 bits. */
+    static unsigned int crc16(unsigned int crc, twoBytes symbol);
+
+    /** CRC32C of one more byte. */
+    static unsigned int crc8(unsigned int crc, byte symbol);
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+/** CRC32C with the SSE4.2 crc32 instruction, only for loops built for
+ * SSE4.2 or better.
+ */
+struct HardwareCrc {
+    /** CRC32C of two more bytes, the first in the low 8 bits. */
+    TARGET_SSE42 static unsigned int crc16(unsigned int crc,
+            twoBytes symbol) {
+        return _mm_crc32_u16(crc, symbol);
+    }
+
+    /** CRC32C of one more byte. */
+    TARGET_SSE42 static unsigned int crc8(unsigned int crc, byte symbol) {
+        return _mm_crc32_u8(crc, symbol);
+    }
+};
+#else
+typedef SoftwareCrc HardwareCrc;
+#endif
+
+#endif // BITKERNEL_HPP
@@ -3,65 +3,15 @@
  * cyeh@ucsd.edu
  * Implementation of a BitOutputStream.
  * Implements methods for reading individual bits, bytes, or ints.
+ * The rest are inline in the header, to build into each kernel's loops.
  */
 #include "BitOutputStream.hpp"
 
-/** Send the buffer to the output stream, and clear it */
-void BitOutputStream::flush() {
-    out.put(buf);  // Write the bitwise buffer to the ostream.
-    out.flush(); // Flush the ostream (optional, slower to do it here)
-    buf = 0;
-    nbits = 0;
-}
-
-/** Write the least significant bit of the argument to
- * the bit buffer, and increment the bit buffer index.
- * But flush the buffer first, if it is full.
- * @param bit 1 or 0.
- */
-void BitOutputStream::writeBit(unsigned int bit) {
-    // Flush the buffer if full.
-    if (nbits == CHAR_BIT) {
-        flush();
-        nbytes++;
-    }
-    // Write the least significant bit of i into the buffer at the current index.
-    buf |= bit << nbits;
-    // Increment index.
-    nbits++;
-}
-
 /** Write a (4) byte int in bits
  * @param num int to write.
  */
 void BitOutputStream::writeInt(unsigned int num) {
-    unsigned int bit;
-    for (int i = 0; i < sizeof(int) * CHAR_BIT; i++) {
-        bit = (num >> i) & 1;
-        writeBit(bit);
-    }
-}
-
-/** Write a (2) byte int in bits
- * @param symbol short to write.
- */
-void BitOutputStream::writeShort(twoBytes symbol) {
-    unsigned int bit;
-    for (int i = 0; i < sizeof(short) * CHAR_BIT; i++) {
-        bit = (symbol >> i) & 1;
-        writeBit(bit);
-    }
-}
-
-/** Write a (8) bit symbol in bits
- * @param symbol character or ascii value to write.
- */
-void BitOutputStream::writeByte(byte symbol) {
-    unsigned int bit;
-    for (int i = 0; i < CHAR_BIT; i++) {
-        bit = (symbol >> i) & 1;
-        writeBit(bit);
-    }
+    writeBits(num, sizeof(int) * CHAR_BIT);
 }
 
 /** Make sure we get the last byte in
@@ -72,12 +22,9 @@ int BitOutputStream::pad() {
     if (nbits == 0) {
         return 0;
     }
-    while (nbits != CHAR_BIT) {
-        buf |= 0 << nbits;
-        nbits++;
-    }
+    // The bits above nbits are already zero.
+    nbits = CHAR_BIT;
     flush();
-    nbytes++;
     return nbitsBeforePadding;
 }
 
@@ -3,34 +3,62 @@
  * cyeh@ucsd.edu
  * Header file representing a BitInputStream.
  * It is instantiated with a node representing the empty string.
- * @buf One byte buffer of bits.
+ * @buf Buffer of bits not yet sent, fewer than a byte between writes.
  * @nbits How many bits have been written to buf.
  * @nbytes How many bytes have been written so far.
  * @out Reference to the output stream to use.
  */
 #include "HCNode.hpp"
+#include "BitKernel.hpp"
 #include <climits>
 
 class BitOutputStream {
 private:
-    byte buf;
+    unsigned long long buf;
     int nbits;
     int nbytes;
     ostream& out;
 
 public:
     /** Constructor, clear buffer and bit counter. */
-    BitOutputStream(ostream & os) : out(os), buf(0), nbits(0) {}
+    BitOutputStream(ostream & os)
+        : buf(0), nbits(0), nbytes(0), out(os) {}
 
-    /** Send the buffer to the output stream, and clear it */
-    void flush();
+    /** Send every whole byte in the buffer to the output stream */
+    ALWAYS_INLINE void flush() {
+        while (nbits >= CHAR_BIT) {
+            out.put((char) buf);  // Write the lowest byte to the ostream.
+            buf >>= CHAR_BIT;
+            nbits -= CHAR_BIT;
+            nbytes++;
+        }
+    }
+
+    /** Write the low count bits of the argument, lowest first.
+     * @param bits the bits.
+     * @param count how many, up to 64.
+     */
+    ALWAYS_INLINE void writeBits(unsigned long long bits, unsigned int count) {
+        // At most 7 bits wait in buf, so 32 more always fit.
+        if (count > 32) {
+            buf |= (bits & 0xFFFFFFFFull) << nbits;
+            nbits += 32;
+            flush();
+            bits >>= 32;
+            count -= 32;
+        }
+        buf |= (bits & ((1ull << count) - 1)) << nbits;
+        nbits += count;
+        flush();
+    }
 
     /** Write the least significant bit of the argument to
      * the bit buffer, and increment the bit buffer index.
-     * But flush the buffer first, if it is full.
      * @param bit 1 or 0.
      */
-    void writeBit(unsigned int bit);
+    ALWAYS_INLINE void writeBit(unsigned int bit) {
+        writeBits(bit, 1);
+    }
 
     /** Write a (4) byte int in bits
      * @param num int to write.
@@ -40,12 +68,16 @@ public:
     /** Write a (2) byte int in bits
      * @param symbol short to write.
      */
-    void writeShort(twoBytes symbol);
+    ALWAYS_INLINE void writeShort(twoBytes symbol) {
+        writeBits(symbol, sizeof(short) * CHAR_BIT);
+    }
 
     /** Write a (8) bit symbol in bits
      * @param symbol character or ascii value to write.
      */
-    void writeByte(byte symbol);
+    ALWAYS_INLINE void writeByte(byte symbol) {
+        writeBits(symbol, CHAR_BIT);
+    }
 
     /** Make sure we get the last byte in
      * @return number of bits before padding.
@@ -0,0 +1,65 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a Checksum.
+ * CRC32C of uncompressed symbols, using the SSE4.2 crc32 instruction in
+ * loops built for it and a lookup table in those that are not.
+ */
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include "BitKernel.hpp"
+
+/** A running CRC32C, updated a symbol at a time as it is coded.
+ *  Every Crc gives the same CRC32C (Castagnoli, reflected 0x82F63B78).
+ *  @crc the checksum so far, inverted.
+ */
+class Checksum {
+private:
+    unsigned int crc;
+
+public:
+    /** Symbols in each checksummed block of a file. */
+    const static unsigned int BLOCK_SYMBOLS = 32768;
+
+    /** Constructor, checksum of nothing. */
+    Checksum() : crc(0xFFFFFFFF) { }
+
+    /** Start over for the next block. */
+    void reset() {
+        crc = 0xFFFFFFFF;
+    }
+
+    /** Add a symbol's bytes, first byte in the low 8 bits.
+     * @param Crc SoftwareCrc, or HardwareCrc in loops built for SSE4.2.
+     * @param symbol the symbol.
+     * @param numBytes 2, or 1 for the lone last byte of an odd file.
+     */
+    template <typename Crc>
+    ALWAYS_INLINE void update(twoBytes symbol, int numBytes) {
+        crc = numBytes == 2 ? Crc::crc16(crc, symbol)
+                : Crc::crc8(crc, (byte) symbol);
+    }
+
+    /** Add a file's header, so the first block checks it too.
+     * Bytes go in as the header has them, the count's lowest first.
+     * @param Crc SoftwareCrc, or HardwareCrc in loops built for SSE4.2.
+     * @param numCharacters the header's count of characters.
+     * @param flags the header's flags.
+     */
+    template <typename Crc>
+    ALWAYS_INLINE void updateHeader(unsigned int numCharacters, byte flags) {
+        update<Crc>(numCharacters, 2);
+        update<Crc>(numCharacters >> 16, 2);
+        update<Crc>(flags, 1);
+    }
+
+    /** Get the checksum of everything since the last reset.
+     * @return the CRC32C.
+     */
+    unsigned int value() const {
+        return ~crc;
+    }
+};
+
+#endif // CHECKSUM_HPP
@@ -0,0 +1,387 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a CodeSearch.
+ * Cores are found in the compressed bits without decoding. Codes are not
+ * self-synchronizing, so a core found mid-code is a false start: the
+ * symbols are walked, without writing them out, only as far as the last
+ * start found, and each start is confirmed on a symbol boundary along
+ * with the partial bytes at either end of the pattern.
+ */
+#include <algorithm>
+#include <deque>
+#include "CodeSearch.hpp"
+#include "Checksum.hpp"
+
+/** A step of the scan table: the state after a byte of bits, and which
+ * of those bits ended a core.
+ */
+struct ScanStep {
+    unsigned int state;
+    byte ends;
+};
+
+/** Constructor
+ * @param data the whole compressed file.
+ * @param tree the file's tree.
+ * @param hasEscape whether missing symbols are escaped.
+ * @param escape the escape symbol.
+ * @param checked whether a checksum follows each block.
+ */
+CodeSearch::CodeSearch(const string& data, const HCTree& tree,
+        bool hasEscape, twoBytes escape, bool checked)
+    : data(data), root(tree.getRoot()), hasEscape(hasEscape),
+      escape(escape), checked(checked), maxSymbolBits(0) {
+    collectCodes(root, "");
+    for (const auto& code : codes) {
+        maxSymbolBits = max(maxSymbolBits, (unsigned long) code.second.size());
+    }
+    if (hasEscape) {
+        maxSymbolBits += sizeof(twoBytes) * CHAR_BIT;
+    }
+}
+
+/** Record the code bits of every leaf under node.
+ * @param node where to start.
+ * @param code bits leading to node.
+ */
+void CodeSearch::collectCodes(const HCNode* node, const string& code) {
+    if (node->c0 == nullptr && node->c1 == nullptr) {
+        codes[node->symbol] = code;
+        return;
+    }
+    collectCodes(node->c0, code + "0");
+    collectCodes(node->c1, code + "1");
+}
+
+/** Helper for treeBits, pre-order like HCTree::writeHeaderHelper.
+ * @param node where to start.
+ * @return bits node and everything under it take up.
+ */
+static unsigned long nodeBits(const HCNode* node) {
+    if (node->c0 == nullptr && node->c1 == nullptr) {
+        return 1 + sizeof(twoBytes) * CHAR_BIT;
+    }
+    return 1 + nodeBits(node->c0) + nodeBits(node->c1);
+}
+
+/** Get how many bits the tree takes up in the header.
+ * @return the bits readTree reads.
+ */
+unsigned long CodeSearch::treeBits() const {
+    if (root->c0 == nullptr && root->c1 == nullptr) {
+        return 1 + sizeof(twoBytes) * CHAR_BIT;
+    }
+    return 1 + nodeBits(root);
+}
+
+/** Get the bits a full symbol is coded with, escaped or not.
+ * @param symbol the symbol.
+ * @param bits where to add the bits.
+ * @return false if the symbol cannot be coded.
+ */
+bool CodeSearch::codeOf(twoBytes symbol, string& bits) const {
+    auto found = codes.find(symbol);
+    // The escape's own code is always followed by raw bits.
+    if (found != codes.end() && !(hasEscape && symbol == escape)) {
+        bits += found->second;
+        return true;
+    }
+    if (!hasEscape) {
+        return false;
+    }
+    // Escape code, then the raw symbol low bit first.
+    bits += codes.at(escape);
+    for (int i = 0; i < (int) (sizeof(twoBytes) * CHAR_BIT); i++) {
+        bits += (char) ('0' + ((symbol >> i) & 1));
+    }
+    return true;
+}
+
+/** Turn the pattern into symbols for one alignment.
+ * @param pattern the bytes to find.
+ * @param lead 1 to start in the high byte of a symbol, else 0.
+ * @return the alignment, with its core.
+ */
+Alignment CodeSearch::align(const string& pattern, int lead) const {
+    Alignment alignment;
+    alignment.lead = lead;
+    alignment.possible = true;
+    alignment.filtered = false;
+    size_t i = 0;
+    if (lead == 1) {
+        alignment.values.push_back(((twoBytes) (byte) pattern[0]) << 8);
+        alignment.masks.push_back(0xFF00);
+        i = 1;
+    }
+    unsigned int coreSymbols = 0;
+    for (; i < pattern.size(); i += 2) {
+        if (i + 1 == pattern.size()) {
+            // Pattern ends in the low byte of a symbol.
+            alignment.values.push_back((byte) pattern[i]);
+            alignment.masks.push_back(0x00FF);
+            break;
+        }
+        twoBytes symbol = (((twoBytes) (byte) pattern[i + 1]) << 8)
+                | (byte) pattern[i];
+        alignment.values.push_back(symbol);
+        alignment.masks.push_back(0xFFFF);
+        if (coreSymbols < MAX_CORE) {
+            alignment.possible = codeOf(symbol, alignment.core);
+            coreSymbols++;
+        } else if (!hasEscape && codes.count(symbol) == 0) {
+            alignment.possible = false;
+        }
+        if (!alignment.possible) {
+            break;
+        }
+    }
+    return alignment;
+}
+
+/** Find every place a core occurs in the compressed bits, one byte
+ * of input at a time with a table built from the core's KMP automaton.
+ * @param alignment whose core to find, adding to its starts.
+ * @param from first bit that may start a match.
+ */
+void CodeSearch::scan(Alignment& alignment, unsigned long from) const {
+    const string& core = alignment.core;
+    unsigned int length = core.size();
+    // KMP failure function over the core's bits.
+    vector<unsigned int> fail(length, 0);
+    for (unsigned int i = 1, k = 0; i < length; i++) {
+        while (k > 0 && core[i] != core[k]) {
+            k = fail[k - 1];
+        }
+        if (core[i] == core[k]) {
+            k++;
+        }
+        fail[i] = k;
+    }
+    // Table of what a whole byte of bits does from each state.
+    vector<ScanStep> table((length + 1) * 256);
+    for (unsigned int state = 0; state <= length; state++) {
+        for (int value = 0; value < 256; value++) {
+            unsigned int s = state;
+            byte ends = 0;
+            for (int bit = 0; bit < CHAR_BIT; bit++) {
+                char c = (char) ('0' + ((value >> bit) & 1));
+                if (s == length) {
+                    s = fail[s - 1];
+                }
+                while (s > 0 && core[s] != c) {
+                    s = fail[s - 1];
+                }
+                if (core[s] == c) {
+                    s++;
+                }
+                if (s == length) {
+                    ends |= 1 << bit;
+                }
+            }
+            table[state * 256 + value] = {s, (byte) ends};
+        }
+    }
+    unsigned int state = 0;
+    for (unsigned long i = 0; i < data.size(); i++) {
+        const ScanStep& step = table[state * 256 + (byte) data[i]];
+        state = step.state;
+        for (int bit = 0; step.ends != 0 && bit < CHAR_BIT; bit++) {
+            unsigned long end = i * CHAR_BIT + bit;
+            if (((step.ends >> bit) & 1) && end + 1 >= from + length) {
+                alignment.starts.insert(end + 1 - length);
+            }
+        }
+    }
+}
+
+/** Find every offset of the pattern in the uncompressed file.
+ * @param pattern the bytes to find.
+ * @param start bit where the first code begins.
+ * @param numCharacters how many total characters there are.
+ * @return offsets of each match, in order.
+ */
+vector<unsigned long> CodeSearch::find(const string& pattern,
+        unsigned long start, unsigned int numCharacters) {
+    vector<unsigned long> offsets;
+    vector<Alignment> alignments;
+    for (int lead = 0; lead < 2; lead++) {
+        Alignment alignment = align(pattern, lead);
+        if (!alignment.possible) {
+            continue;
+        }
+        alignment.filtered = !alignment.core.empty();
+        if (alignment.filtered) {
+            scan(alignment, start);
+        }
+        alignments.push_back(alignment);
+    }
+    // Where cores were found, in order, and how many symbols a match needs.
+    vector<unsigned long> candidates;
+    size_t window = 0;
+    bool everywhere = false;
+    for (const Alignment& alignment : alignments) {
+        if (alignment.filtered) {
+            candidates.insert(candidates.end(), alignment.starts.begin(),
+                    alignment.starts.end());
+        } else {
+            everywhere = true;
+        }
+        window = max(window, alignment.values.size());
+    }
+    // A checksum sits between the codes of two blocks, so scan can't see
+    // a match that spans one. Walk the symbols around each block end.
+    bool boundaries = checked && window > 1;
+    if (candidates.empty() && !everywhere && !boundaries) {
+        return offsets;
+    }
+    sort(candidates.begin(), candidates.end());
+    bool skipping = !everywhere && buildSkipTable();
+    // Walk the codes, keeping the last few symbols and where they began.
+    deque<pair<twoBytes, unsigned long>> recent;
+    unsigned int numSymbols = (numCharacters / 2) + (numCharacters % 2);
+    unsigned long dataBits = data.size() * CHAR_BIT;
+    unsigned long pos = start;
+    unsigned long symbolStart = start;
+    const HCNode* curr = root;
+    unsigned int currId = 0;
+    unsigned int index = 0;
+    unsigned int inBlock = 0;
+    size_t next = 0;
+    unsigned int neededUntil = 0;
+    while (index < numSymbols && pos <= dataBits) {
+        if (!everywhere && !boundaries && next == candidates.size()
+                && index > neededUntil) {
+            break; // Every core found has been checked.
+        }
+        // Far from the next core and block end, skip a byte of codes at a
+        // time.
+        bool needed = everywhere || index <= neededUntil
+                || (next < candidates.size()
+                    && candidates[next] < pos + CHAR_BIT + maxSymbolBits)
+                || (boundaries && (inBlock < window || inBlock + window
+                    + CHAR_BIT >= Checksum::BLOCK_SYMBOLS));
+        if (skipping && !needed && pos % CHAR_BIT == 0
+                && index + CHAR_BIT < numSymbols
+                && (!checked || inBlock + CHAR_BIT < Checksum::BLOCK_SYMBOLS)) {
+            const SkipStep& step =
+                    skipTable[currId * 256 + (byte) data[pos >> 3]];
+            if (step.clean) {
+                currId = step.node;
+                curr = skipNodes[currId];
+                index += step.symbols;
+                inBlock += step.symbols;
+                pos += CHAR_BIT;
+                // Mid-code symbols have no known start.
+                symbolStart = curr == root ? pos : dataBits;
+                if (!recent.empty()) {
+                    recent.clear();
+                }
+                continue;
+            }
+        }
+        // One bit at a time, up to the end of the next symbol.
+        while (curr->c0 != nullptr && curr->c1 != nullptr && pos < dataBits) {
+            curr = bitAt(pos++) ? curr->c1 : curr->c0;
+        }
+        twoBytes symbol = curr->symbol;
+        curr = root;
+        currId = 0;
+        if (hasEscape && symbol == escape) {
+            symbol = 0;
+            for (int i = 0; i < (int) (sizeof(twoBytes) * CHAR_BIT)
+                    && pos < dataBits; i++) {
+                symbol |= bitAt(pos++) << i;
+            }
+        }
+        if (checked && (++inBlock == Checksum::BLOCK_SYMBOLS
+                || index + 1 == numSymbols)) {
+            pos += sizeof(int) * CHAR_BIT;
+            inBlock = 0;
+        }
+        recent.push_back(make_pair(symbol, symbolStart));
+        if (recent.size() > window) {
+            recent.pop_front();
+        }
+        // Reached a core, keep every symbol until its match is complete.
+        while (symbolStart < dataBits && next < candidates.size()
+                && candidates[next] <= symbolStart) {
+            next++;
+            neededUntil = index + window;
+        }
+        symbolStart = pos;
+        // Does a match end with this symbol?
+        for (const Alignment& alignment : alignments) {
+            size_t m = alignment.values.size();
+            if (recent.size() < m) {
+                continue;
+            }
+            size_t first = recent.size() - m;
+            unsigned int block = index / Checksum::BLOCK_SYMBOLS;
+            bool spans = boundaries
+                    && (index + 1 - m) / Checksum::BLOCK_SYMBOLS != block;
+            if (alignment.filtered && !spans && alignment.starts.count(
+                    recent[first + alignment.lead].second) == 0) {
+                continue;
+            }
+            bool matched = true;
+            for (size_t i = 0; i < m && matched; i++) {
+                matched = (recent[first + i].first & alignment.masks[i])
+                        == alignment.values[i];
+            }
+            unsigned long offset = 2ul * (index + 1 - m) + alignment.lead;
+            if (matched && offset + pattern.size() <= numCharacters) {
+                offsets.push_back(offset);
+            }
+        }
+        index++;
+    }
+    sort(offsets.begin(), offsets.end());
+    return offsets;
+}
+
+/** Build the table for skipping a byte of codes at a time, if the tree
+ * is small enough.
+ * @return false if the tree is too big, or just one leaf.
+ */
+bool CodeSearch::buildSkipTable() {
+    if (!skipNodes.empty()) {
+        return true;
+    }
+    // Number the internal nodes, root first.
+    vector<const HCNode*> stack(1, root);
+    while (!stack.empty()) {
+        const HCNode* node = stack.back();
+        stack.pop_back();
+        if (node->c0 != nullptr && node->c1 != nullptr) {
+            skipIds[node] = skipNodes.size();
+            skipNodes.push_back(node);
+            stack.push_back(node->c0);
+            stack.push_back(node->c1);
+        }
+    }
+    if (skipNodes.empty() || skipNodes.size() > MAX_SKIP_NODES) {
+        skipNodes.clear();
+        skipIds.clear();
+        return false;
+    }
+    skipTable.resize(skipNodes.size() * 256);
+    for (size_t id = 0; id < skipNodes.size(); id++) {
+        for (int value = 0; value < 256; value++) {
+            SkipStep step = {0, 0, true};
+            const HCNode* node = skipNodes[id];
+            for (int bit = 0; bit < CHAR_BIT && step.clean; bit++) {
+                node = ((value >> bit) & 1) ? node->c1 : node->c0;
+                if (node->c0 == nullptr && node->c1 == nullptr) {
+                    // Raw bits follow an escape, they are not codes.
+                    step.clean = !(hasEscape && node->symbol == escape);
+                    step.symbols++;
+                    node = root;
+                }
+            }
+            step.node = skipIds.at(node);
+            skipTable[id * 256 + value] = step;
+        }
+    }
+    return true;
+}
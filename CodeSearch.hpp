@@ -0,0 +1,142 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a CodeSearch.
+ * Finds a literal pattern in a file compressed with a static HCTree by
+ * looking for the codes the pattern turns into, then decoding only enough
+ * to confirm where those codes start.
+ */
+#ifndef CODESEARCH_HPP
+#define CODESEARCH_HPP
+
+#include "HCTree.hpp"
+
+/** One way the pattern can line up with the symbols in the file.
+ *  @values what each symbol in the match must hold.
+ *  @masks which bytes of each symbol the pattern covers.
+ *  @lead 1 if the pattern starts in the high byte of a symbol, else 0.
+ *  @possible false if some full symbol cannot be coded by the tree.
+ *  @core code bits of the full symbols after lead, as '0' and '1'.
+ *  @filtered whether only starts may begin a match.
+ *  @starts bits where core was found in the file.
+ */
+struct Alignment {
+    vector<twoBytes> values;
+    vector<twoBytes> masks;
+    int lead;
+    bool possible;
+    string core;
+    bool filtered;
+    unordered_set<unsigned long> starts;
+};
+
+/** A step of the skip table.
+ *  @node number of the node after a byte of bits.
+ *  @symbols how many symbols ended in the byte.
+ *  @clean false if the byte held raw bits after an escape.
+ */
+struct SkipStep {
+    unsigned int node;
+    byte symbols;
+    bool clean;
+};
+
+/** Searches the coded symbols of one file for a pattern.
+ *  @data the whole compressed file.
+ *  @root root of the file's tree.
+ *  @hasEscape whether missing symbols are escaped.
+ *  @escape the escape symbol.
+ *  @checked whether a checksum follows each block.
+ *  @codes code bits of each symbol in the tree.
+ *  @maxSymbolBits most bits one symbol takes, escape included.
+ *  @skipNodes internal nodes of the tree, numbered for skipTable.
+ *  @skipIds number of each internal node.
+ *  @skipTable what a byte of bits does from each internal node.
+ */
+class CodeSearch {
+private:
+    const string& data;
+    const HCNode* root;
+    bool hasEscape;
+    twoBytes escape;
+    bool checked;
+    unordered_map<twoBytes, string> codes;
+    unsigned long maxSymbolBits;
+    vector<const HCNode*> skipNodes;
+    unordered_map<const HCNode*, unsigned int> skipIds;
+    vector<SkipStep> skipTable;
+
+    /** Get the bit at a position of data, in the order BitOutputStream
+     * writes them.
+     * @param pos index of the bit.
+     * @return 1 or 0.
+     */
+    int bitAt(unsigned long pos) const {
+        return (((byte) data[pos >> 3]) >> (pos & 7)) & 1;
+    }
+
+    /** Record the code bits of every leaf under node.
+     * @param node where to start.
+     * @param code bits leading to node.
+     */
+    void collectCodes(const HCNode* node, const string& code);
+
+    /** Get the bits a full symbol is coded with, escaped or not.
+     * @param symbol the symbol.
+     * @param bits where to add the bits.
+     * @return false if the symbol cannot be coded.
+     */
+    bool codeOf(twoBytes symbol, string& bits) const;
+
+    /** Turn the pattern into symbols for one alignment.
+     * @param pattern the bytes to find.
+     * @param lead 1 to start in the high byte of a symbol, else 0.
+     * @return the alignment, with its core.
+     */
+    Alignment align(const string& pattern, int lead) const;
+
+    /** Find every place a core occurs in the compressed bits, one byte
+     * of input at a time with a table built from the core's KMP automaton.
+     * @param alignment whose core to find, adding to its starts.
+     * @param from first bit that may start a match.
+     */
+    void scan(Alignment& alignment, unsigned long from) const;
+
+    /** Build the table for skipping a byte of codes at a time, if the tree
+     * is small enough.
+     * @return false if the tree is too big, or just one leaf.
+     */
+    bool buildSkipTable();
+
+public:
+    /** Most internal nodes to build a skip table for. */
+    const static unsigned int MAX_SKIP_NODES = 8192;
+    /** Most full symbols put in a core, to keep scan tables small. */
+    const static unsigned int MAX_CORE = 256;
+
+    /** Constructor
+     * @param data the whole compressed file.
+     * @param tree the file's tree.
+     * @param hasEscape whether missing symbols are escaped.
+     * @param escape the escape symbol.
+     * @param checked whether a checksum follows each block.
+     */
+    CodeSearch(const string& data, const HCTree& tree, bool hasEscape,
+            twoBytes escape, bool checked);
+
+    /** Get how many bits the tree takes up in the header.
+     * @return the bits readTree reads.
+     */
+    unsigned long treeBits() const;
+
+    /** Find every offset of the pattern in the uncompressed file.
+     * @param pattern the bytes to find.
+     * @param start bit where the first code begins.
+     * @param numCharacters how many total characters there are.
+     * @return offsets of each match, in order.
+     */
+    vector<unsigned long> find(const string& pattern, unsigned long start,
+            unsigned int numCharacters);
+};
+
+#endif // CODESEARCH_HPP
@@ -0,0 +1,386 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a Compressor.
+ * Symbols are pairs of bytes, the first byte in the low 8 bits.
+ */
+#include <algorithm>
+#include <cstring>
+#include "Compressor.hpp"
+#include "Checksum.hpp"
+
+const unsigned int Compressor::SAMPLE_BYTES;
+const unsigned int Compressor::SAMPLE_CHUNK;
+const unsigned long Compressor::MAX_BYTES;
+
+/**
+ * Read the symbol made up of the next (up to) two bytes.
+ * @param in our input stream for bits.
+ * @param remaining how many characters are left to read.
+ * @return the symbol, with the first byte in the low 8 bits.
+ */
+static twoBytes readSymbol(BitInputStream& in, unsigned int remaining) {
+    // Odd number of characters, last symbol is a lone byte.
+    if (remaining == 1) {
+        return in.readByte();
+    }
+    // Bits come lowest first, so the first byte lands in the low 8 bits.
+    return in.readShort();
+}
+
+/** Add the header flag for a command line option like -s.
+ * -s builds the tree from a sample of the file,
+ * -a codes in one pass with an adaptive tree and no tree header,
+ * -o codes each symbol with a table picked by the previous symbol,
+ * -c adds a checksum of each block, with any of the above.
+ * @param option the option.
+ * @param flags header flags to add to.
+ * @return false if the option is not ours.
+ */
+bool Compressor::parseOption(const char* option, byte& flags) {
+    if (strcmp(option, "-s") == 0) {
+        flags |= HCTree::SAMPLED;
+    } else if (strcmp(option, "-a") == 0) {
+        flags |= HCTree::ADAPTIVE;
+    } else if (strcmp(option, "-o") == 0) {
+        flags |= HCTree::ORDER1;
+    } else if (strcmp(option, "-c") == 0) {
+        flags |= HCTree::CHECKSUM;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/** Check options picked at most one engine, and no flags we don't know.
+ * @param flags header flags from parseOption, or a file's header.
+ * @return true if they can be used together.
+ */
+bool Compressor::validFlags(byte flags) {
+    const byte known = HCTree::SAMPLED | HCTree::ADAPTIVE | HCTree::ORDER1
+            | HCTree::CHECKSUM;
+    if (flags & ~known) {
+        return false;
+    }
+    byte engine = flags & ~HCTree::CHECKSUM;
+    return (engine & (engine - 1)) == 0;
+}
+
+/** Compress a file. An empty file compresses to an empty file.
+ * @param infile name of the file to compress.
+ * @param outfile name of the file to write.
+ * @param flags header flags picking the engine, at most one.
+ * @return sizes, or why the file could not be compressed.
+ */
+CompressResult Compressor::compress(const string& infile,
+        const string& outfile, byte flags) {
+    CompressResult result = {false, "", 0, 0};
+    input.clear();
+    input.open(infile, ios_base::binary);
+    if (!input.is_open()) {
+        result.error = "cannot open " + infile;
+        return result;
+    }
+    output.clear();
+    output.open(outfile, ios_base::trunc);
+    if (!output.is_open()) {
+        input.close();
+        result.error = "cannot open " + outfile;
+        return result;
+    }
+    result = compress(input, output, flags, infile, outfile);
+    input.close();
+    output.close();
+    return result;
+}
+
+/** Compress everything in a stream, such as a buffer in memory.
+ * Empty input compresses to nothing.
+ * @param in stream to compress, which must be able to seek.
+ * @param out stream to write to.
+ * @param flags header flags picking the engine, at most one.
+ * @param inName what to call in in errors.
+ * @param outName what to call out in errors.
+ * @return sizes, or why the input could not be compressed.
+ */
+CompressResult Compressor::compress(istream& in, ostream& out, byte flags,
+        const string& inName, const string& outName) {
+    CompressResult result = {false, "", 0, 0};
+    source = &in;
+    in.seekg(0, ios::end);
+    streamoff size = in.tellg();
+    in.clear();
+    in.seekg(0);
+    if (size < 0 || (unsigned long) size > MAX_BYTES) {
+        result.error = "cannot size " + inName;
+    } else if (size > 0) { // If input is empty, don't write anything.
+        unsigned int numCharacters = size;
+        streamoff start = out.tellp();
+        BitInputStream bitIn = BitInputStream(in);
+        BitOutputStream bitOut = BitOutputStream(out);
+        if (flags & HCTree::ADAPTIVE) {
+            compressAdaptive(bitIn, bitOut, numCharacters, flags);
+        } else if (flags & HCTree::ORDER1) {
+            compressContext(bitIn, bitOut, numCharacters, flags);
+        } else {
+            compressStatic(bitIn, bitOut, numCharacters, flags);
+        }
+        result.outBytes = out.tellp() - start;
+        if (!out.good()) {
+            result.error = "cannot write " + outName;
+        }
+    }
+    result.inBytes = max(size, (streamoff) 0);
+    result.ok = result.error.empty();
+    source = nullptr;
+    return result;
+}
+
+/** Encode every symbol of the input with the given coder.
+ * With checksums, each block of symbols is followed by its CRC32C,
+ * computed as the symbols go by. The first block's covers the header's
+ * count and flags too. Built into each kernel's encode loop.
+ * @param Crc how to compute the checksums.
+ * @param coder coder with an encode(twoBytes, BitOutputStream&) method.
+ * @param bitIn our input stream for bits.
+ * @param bitOut our output stream for bits.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, CHECKSUM to write checksums.
+ */
+template <typename Crc, typename Coder>
+static ALWAYS_INLINE void encodeSymbols(Coder& coder, BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    bool checked = flags & HCTree::CHECKSUM;
+    Checksum checksum;
+    checksum.updateHeader<Crc>(numCharacters, flags);
+    unsigned int inBlock = 0;
+    for (unsigned int read = 0; read < numCharacters; read += 2) {
+        twoBytes symbol = readSymbol(bitIn, numCharacters - read);
+        coder.encode(symbol, bitOut);
+        if (checked) {
+            checksum.update<Crc>(symbol, min(numCharacters - read, 2u));
+            inBlock++;
+            // End of a block, or of the file.
+            if (inBlock == Checksum::BLOCK_SYMBOLS
+                    || read + 2 >= numCharacters) {
+                bitOut.writeInt(checksum.value());
+                checksum.reset();
+                inBlock = 0;
+            }
+        }
+    }
+}
+
+/** encodeSymbols for any CPU. */
+template <typename Coder>
+static void encodeGeneric(Coder& coder, BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    encodeSymbols<SoftwareCrc>(coder, bitIn, bitOut, numCharacters, flags);
+}
+
+/** encodeSymbols for CPUs with SSE4.2. */
+template <typename Coder>
+TARGET_SSE42 static void encodeSse42(Coder& coder, BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    encodeSymbols<HardwareCrc>(coder, bitIn, bitOut, numCharacters, flags);
+}
+
+/** encodeSymbols for CPUs with BMI2. */
+template <typename Coder>
+TARGET_BMI2 static void encodeBmi2(Coder& coder, BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    encodeSymbols<HardwareCrc>(coder, bitIn, bitOut, numCharacters, flags);
+}
+
+/** Encode every symbol of the input with the given coder, in the build
+ * of the loop for the current kernel.
+ * @param coder coder with an encode(twoBytes, BitOutputStream&) method.
+ * @param bitIn our input stream for bits.
+ * @param bitOut our output stream for bits.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, CHECKSUM to write checksums.
+ */
+template <typename Coder>
+void Compressor::encodeAll(Coder& coder, BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    typedef void (*Loop)(Coder&, BitInputStream&, BitOutputStream&,
+            unsigned int, byte);
+    // Indexed by BitKernel level.
+    static const Loop loops[] = {
+        encodeGeneric<Coder>, encodeSse42<Coder>, encodeBmi2<Coder>
+    };
+    loops[BitKernel::current().level](coder, bitIn, bitOut, numCharacters,
+            flags);
+}
+
+/** Count the next length characters of the input by symbol. Built into
+ * each kernel's counting loop.
+ * @param bitIn our input stream for bits.
+ * @param counts count of each symbol, added to.
+ * @param remaining how many characters are left in the input.
+ * @param length how many to count, all of remaining or an even number.
+ */
+static ALWAYS_INLINE void countSymbols(BitInputStream& bitIn,
+        unsigned int* counts, unsigned int remaining, unsigned int length) {
+    for (unsigned int read = 0; read < length; read += 2) {
+        counts[readSymbol(bitIn, remaining - read)]++;
+    }
+}
+
+/** countSymbols for any CPU. */
+static void countGeneric(BitInputStream& bitIn, unsigned int* counts,
+        unsigned int remaining, unsigned int length) {
+    countSymbols(bitIn, counts, remaining, length);
+}
+
+/** countSymbols for CPUs with SSE4.2. */
+TARGET_SSE42 static void countSse42(BitInputStream& bitIn,
+        unsigned int* counts, unsigned int remaining, unsigned int length) {
+    countSymbols(bitIn, counts, remaining, length);
+}
+
+/** countSymbols for CPUs with BMI2. */
+TARGET_BMI2 static void countBmi2(BitInputStream& bitIn,
+        unsigned int* counts, unsigned int remaining, unsigned int length) {
+    countSymbols(bitIn, counts, remaining, length);
+}
+
+/** Count the next length characters of the input into counts, in the
+ * build of the loop for the current kernel.
+ * @param bitIn our input stream for bits.
+ * @param remaining how many characters are left in the input.
+ * @param length how many to count, all of remaining or an even number.
+ */
+void Compressor::countAll(BitInputStream& bitIn, unsigned int remaining,
+        unsigned int length) {
+    typedef void (*Loop)(BitInputStream&, unsigned int*, unsigned int,
+            unsigned int);
+    // Indexed by BitKernel level.
+    static const Loop loops[] = {countGeneric, countSse42, countBmi2};
+    loops[BitKernel::current().level](bitIn, counts.data(), remaining,
+            length);
+}
+
+/** Count symbols into counts from a strided sample of the input, SAMPLE_CHUNK
+ * bytes at a time spread evenly over the file, up to SAMPLE_BYTES in total.
+ * @param bitIn our input stream for bits.
+ * @param numCharacters how many total characters there are.
+ */
+void Compressor::sampleFreqs(BitInputStream& bitIn,
+        unsigned int numCharacters) {
+    unsigned int numChunks = SAMPLE_BYTES / SAMPLE_CHUNK;
+    // Chunks start at even offsets so they line up with our symbols.
+    unsigned int stride = (numCharacters / numChunks) & ~1u;
+    if (numCharacters <= SAMPLE_BYTES) {
+        numChunks = 1;
+        stride = 0;
+    }
+    for (unsigned int i = 0; i < numChunks; i++) {
+        unsigned int offset = i * stride;
+        unsigned int length = min(numCharacters - offset,
+                stride == 0 ? numCharacters : SAMPLE_CHUNK);
+        source->clear();
+        source->seekg(offset);
+        countAll(bitIn, numCharacters - offset, length);
+    }
+}
+
+/** Code the input with a tree, from all or a sample of the symbols.
+ * @param bitIn our input stream for bits.
+ * @param bitOut our output stream for bits.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, SAMPLED, CHECKSUM or none.
+ */
+void Compressor::compressStatic(BitInputStream& bitIn, BitOutputStream& bitOut,
+        unsigned int numCharacters, byte flags) {
+    bool sampled = flags & HCTree::SAMPLED;
+    bool checked = flags & HCTree::CHECKSUM;
+    unsigned int numUniqueChars = 0;
+    freqs.clear();
+    fill(counts.begin(), counts.end(), 0);
+    tree.reset();
+    // Proceed to read bytes, either all of them or a sample.
+    if (sampled) {
+        sampleFreqs(bitIn, numCharacters);
+    } else {
+        countAll(bitIn, numCharacters, numCharacters);
+    }
+    for (unsigned int symbol = 0; symbol < counts.size(); symbol++) {
+        if (counts[symbol] > 0) {
+            freqs[symbol] = counts[symbol];
+        }
+    }
+    // Symbols missing from a sample are escaped with an unused symbol.
+    if (sampled && freqs.size() < HCTree::TABLE_SIZE) {
+        twoBytes escape = 0;
+        while (freqs.count(escape)) {
+            escape++;
+        }
+        freqs[escape] = 1;
+        tree.setEscape(escape);
+    }
+    // Get our number of unique characters */
+    for (auto freq : freqs) {
+        if (freq.second > 0) {
+            numUniqueChars++;
+        }
+    }
+    tree.build(freqs);
+    // Write our header: count and pre-order traversal of tree.
+    tree.writeHeader(bitOut, numCharacters, numUniqueChars, flags);
+    // Write our encoding. One symbol has no bits, unless it needs checking.
+    if (numUniqueChars > 1 || checked) {
+        source->clear();
+        source->seekg(0);
+        encodeAll(tree, bitIn, bitOut, numCharacters, flags);
+    }
+    // Padding for last.
+    tree.pad(bitOut);
+}
+
+/** Code the input in one pass with the adaptive tree.
+ * Adaptive coding needs no counts up front, just encode as we read. It
+ * still can't stream: the header's character count comes before the
+ * first symbol, so compress() sizes the input by seeking to its end.
+ * @param bitIn our input stream for bits.
+ * @param bitOut our output stream for bits.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, ADAPTIVE and maybe CHECKSUM.
+ */
+void Compressor::compressAdaptive(BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    adaptive.reset();
+    bitOut.writeInt(numCharacters);
+    bitOut.writeByte(flags);
+    encodeAll(adaptive, bitIn, bitOut, numCharacters, flags);
+    bitOut.pad();
+}
+
+/** Code the input with order-1 context tables.
+ * Each symbol is counted in the context it follows.
+ * @param bitIn our input stream for bits.
+ * @param bitOut our output stream for bits.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, ORDER1 and maybe CHECKSUM.
+ */
+void Compressor::compressContext(BitInputStream& bitIn,
+        BitOutputStream& bitOut, unsigned int numCharacters, byte flags) {
+    unsigned int numSymbols = (numCharacters / 2) + (numCharacters % 2);
+    for (auto& contextFreq : contextFreqs) {
+        contextFreq.clear();
+    }
+    twoBytes prev = 0;
+    for (unsigned int i = 0; i < numSymbols; i++) {
+        twoBytes symbol = readSymbol(bitIn, numCharacters - 2 * i);
+        contextFreqs[ContextHCTree::contextOf(prev)][symbol]++;
+        prev = symbol;
+    }
+    context.build(contextFreqs);
+    bitOut.writeInt(numCharacters);
+    bitOut.writeByte(flags);
+    context.writeHeader(bitOut);
+    source->clear();
+    source->seekg(0);
+    encodeAll(context, bitIn, bitOut, numCharacters, flags);
+    bitOut.pad();
+}
@@ -0,0 +1,157 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a Compressor.
+ * Compresses files with any of our engines, keeping its trees, counts and
+ * streams around so one Compressor can do many files without setting up.
+ */
+#ifndef COMPRESSOR_HPP
+#define COMPRESSOR_HPP
+
+#include "HCTree.hpp"
+#include "AdaptiveHCTree.hpp"
+#include "ContextHCTree.hpp"
+
+/** What happened compressing or uncompressing one file or buffer.
+ * @ok whether the file was compressed.
+ * @error why not, if it was not.
+ * @inBytes size of the input.
+ * @outBytes size of the output.
+ */
+struct CompressResult {
+    bool ok;
+    string error;
+    unsigned long inBytes;
+    unsigned long outBytes;
+};
+
+/** Compresses files, reusing its state from one file to the next.
+ *  Not thread safe, use one per thread.
+ *  @input stream of the file being compressed.
+ *  @output stream of the file being written.
+ *  @source stream being compressed, input or a caller's own.
+ *  @tree, @adaptive, @context the engines, reset for each file.
+ *  @counts symbol counts for tree, indexed by symbol.
+ *  @freqs the symbols counted and their counts, for building tree.
+ *  @contextFreqs symbol counts in each context for context.
+ */
+class Compressor {
+private:
+    ifstream input;
+    ofstream output;
+    istream* source;
+    HCTree tree;
+    AdaptiveHCTree adaptive;
+    ContextHCTree context;
+    vector<unsigned int> counts;
+    unordered_map<twoBytes, int> freqs;
+    vector<unordered_map<twoBytes, int>> contextFreqs;
+
+    /** Encode every symbol of the input with the given coder, in the
+     * build of the loop for the current kernel.
+     * @param coder coder with an encode(twoBytes, BitOutputStream&) method.
+     * @param bitIn our input stream for bits.
+     * @param bitOut our output stream for bits.
+     * @param numCharacters how many total characters there are.
+     * @param flags header flags, CHECKSUM to write a checksum after each
+     *     block.
+     */
+    template <typename Coder>
+    void encodeAll(Coder& coder, BitInputStream& bitIn,
+            BitOutputStream& bitOut, unsigned int numCharacters,
+            byte flags);
+
+    /** Count the next length characters of the input into counts, in
+     * the build of the loop for the current kernel.
+     * @param bitIn our input stream for bits.
+     * @param remaining how many characters are left in the input.
+     * @param length how many to count, all of remaining or an even number.
+     */
+    void countAll(BitInputStream& bitIn, unsigned int remaining,
+            unsigned int length);
+
+    /** Count symbols into counts from a strided sample of the input.
+     * @param bitIn our input stream for bits.
+     * @param numCharacters how many total characters there are.
+     */
+    void sampleFreqs(BitInputStream& bitIn, unsigned int numCharacters);
+
+    /** Code the input with a tree, from all or a sample of the symbols.
+     * @param bitIn our input stream for bits.
+     * @param bitOut our output stream for bits.
+     * @param numCharacters how many total characters there are.
+     * @param flags header flags, SAMPLED, CHECKSUM or none.
+     */
+    void compressStatic(BitInputStream& bitIn, BitOutputStream& bitOut,
+            unsigned int numCharacters, byte flags);
+
+    /** Code the input in one pass with the adaptive tree.
+     * @param bitIn our input stream for bits.
+     * @param bitOut our output stream for bits.
+     * @param numCharacters how many total characters there are.
+     * @param flags header flags, ADAPTIVE and maybe CHECKSUM.
+     */
+    void compressAdaptive(BitInputStream& bitIn, BitOutputStream& bitOut,
+            unsigned int numCharacters, byte flags);
+
+    /** Code the input with order-1 context tables.
+     * @param bitIn our input stream for bits.
+     * @param bitOut our output stream for bits.
+     * @param numCharacters how many total characters there are.
+     * @param flags header flags, ORDER1 and maybe CHECKSUM.
+     */
+    void compressContext(BitInputStream& bitIn, BitOutputStream& bitOut,
+            unsigned int numCharacters, byte flags);
+
+public:
+    /** How many bytes the sampled model reads before encoding. */
+    const static unsigned int SAMPLE_BYTES = 4 << 20;
+    /** Size of each contiguous run of bytes in the sample. */
+    const static unsigned int SAMPLE_CHUNK = 64 << 10;
+    /** Largest file we can count the characters of in the header. */
+    const static unsigned long MAX_BYTES = 0xFFFFFFFFul;
+
+    /** Constructor */
+    Compressor()
+        : source(nullptr), counts(HCTree::TABLE_SIZE),
+          contextFreqs(ContextHCTree::NUM_CONTEXTS) { }
+
+    /** Add the header flag for a command line option like -s.
+     * @param option the option.
+     * @param flags header flags to add to.
+     * @return false if the option is not ours.
+     */
+    static bool parseOption(const char* option, byte& flags);
+
+    /** Check options picked at most one engine, and no flags we don't
+     * know.
+     * @param flags header flags from parseOption, or a file's header.
+     * @return true if they can be used together.
+     */
+    static bool validFlags(byte flags);
+
+    /** Compress a file. An empty file compresses to an empty file.
+     * @param infile name of the file to compress.
+     * @param outfile name of the file to write.
+     * @param flags header flags picking the engine, at most one,
+     *     and whether to add checksums.
+     * @return sizes, or why the file could not be compressed.
+     */
+    CompressResult compress(const string& infile, const string& outfile,
+            byte flags);
+
+    /** Compress everything in a stream, such as a buffer in memory.
+     * Empty input compresses to nothing.
+     * @param in stream to compress, which must be able to seek.
+     * @param out stream to write to.
+     * @param flags header flags as for compressing a file.
+     * @param inName what to call in in errors.
+     * @param outName what to call out in errors.
+     * @return sizes, or why the input could not be compressed.
+     */
+    CompressResult compress(istream& in, ostream& out, byte flags,
+            const string& inName = "input",
+            const string& outName = "output");
+};
+
+#endif // COMPRESSOR_HPP
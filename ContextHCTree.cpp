@@ -0,0 +1,112 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a ContextHCTree.
+ * Header: a bit for a shared table, a bit per context for its own table,
+ * then each table's tree in order.
+ */
+#include "ContextHCTree.hpp"
+
+/** Build a table for each context used enough, and a shared table
+ * for the rest.
+ * @param freqs NUM_CONTEXTS maps of symbols and their frequency
+ *     in that context.
+ */
+void ContextHCTree::build(const vector<unordered_map<twoBytes, int>>& freqs) {
+    numTables = 0;
+    unordered_map<twoBytes, int> shared;
+    for (int context = 0; context < NUM_CONTEXTS; context++) {
+        int uses = 0;
+        for (auto freq : freqs[context]) {
+            uses += freq.second;
+        }
+        // Enough uses per symbol to pay for writing a tree.
+        if (uses > 0 && uses >= MIN_USES * (int) freqs[context].size()) {
+            own[context] = true;
+        } else {
+            own[context] = false;
+            for (auto freq : freqs[context]) {
+                shared[freq.first] += freq.second;
+            }
+        }
+    }
+    hasShared = !shared.empty();
+    if (hasShared) {
+        nextTable()->build(shared);
+    }
+    for (int context = 0; context < NUM_CONTEXTS; context++) {
+        if (own[context]) {
+            tableOf[context] = numTables;
+            nextTable()->build(freqs[context]);
+        } else {
+            tableOf[context] = 0;
+        }
+    }
+    prev = 0;
+}
+
+/** Encode our tables: which contexts have their own, then each tree.
+ * PRECONDITION: build() has been called.
+ * @param out our output stream for bits.
+ */
+void ContextHCTree::writeHeader(BitOutputStream& out) const {
+    out.writeBit(hasShared);
+    for (int context = 0; context < NUM_CONTEXTS; context++) {
+        out.writeBit(own[context]);
+    }
+    for (unsigned int i = 0; i < numTables; i++) {
+        tables[i]->writeTree(out);
+    }
+}
+
+/** Build our tables from what writeHeader wrote.
+ * @param in our input stream for bits.
+ * @return false if the header has no table to decode with, or a bad
+ *     one.
+ */
+bool ContextHCTree::buildFromEncoding(BitInputStream& in) {
+    hasShared = in.readBit();
+    unsigned int numToRead = hasShared;
+    // Contexts that were never used may point at any table.
+    for (int context = 0; context < NUM_CONTEXTS; context++) {
+        own[context] = in.readBit();
+        tableOf[context] = own[context] ? numToRead++ : 0;
+    }
+    numTables = 0;
+    prev = 0;
+    // build() always makes a table, so a header without one is garbage.
+    if (numToRead == 0) {
+        return false;
+    }
+    for (unsigned int i = 0; i < numToRead; i++) {
+        if (!nextTable()->readTree(in)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Get an empty table to build, reusing one from before if we can.
+ * @return the table, now counted in numTables.
+ */
+HCTree* ContextHCTree::nextTable() {
+    if (numTables == tables.size()) {
+        tables.push_back(new HCTree());
+    }
+    HCTree* table = tables[numTables++];
+    table->reset();
+    return table;
+}
+
+/** Destructor */
+ContextHCTree::~ContextHCTree() {
+    deleteAll();
+}
+
+/** Delete all tables. */
+void ContextHCTree::deleteAll() {
+    for (HCTree* table : tables) {
+        delete table;
+    }
+    tables.clear();
+}
@@ -0,0 +1,103 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a ContextHCTree.
+ * An order-1 Huffman coder: each symbol is coded with the table for the
+ * byte just before it, so structured data gets much shorter codes.
+ */
+#ifndef CONTEXTHCTREE_HPP
+#define CONTEXTHCTREE_HPP
+
+#include "HCTree.hpp"
+
+/** Huffman code tables selected by the previous symbol.
+ *  Contexts are the last byte of the previous symbol. A context that is
+ *  used too little to pay for its own table shares one with the others.
+ *  @tables the shared table first, if any, then one per own context,
+ *      then spares kept from earlier builds.
+ *  @numTables how many of tables are in use.
+ *  @hasShared whether tables starts with a shared table.
+ *  @own whether each context has its own table.
+ *  @tableOf index into tables for each context.
+ *  @prev the symbol coded last, zero before the first one.
+ */
+class ContextHCTree {
+private:
+    vector<HCTree*> tables;
+    unsigned int numTables;
+    bool hasShared;
+    vector<bool> own;
+    vector<int> tableOf;
+    twoBytes prev;
+
+    /** Get an empty table to build, reusing one from before if we can.
+     * @return the table, now counted in numTables.
+     */
+    HCTree* nextTable();
+
+    /** Delete all tables. */
+    void deleteAll();
+
+public:
+    const static int NUM_CONTEXTS = 256;
+    /** A context gets its own table once each of its unique symbols
+     * is used this many times on average.
+     */
+    const static int MIN_USES = 16;
+
+    /** Constructor, no tables until we build. */
+    ContextHCTree()
+        : numTables(0), hasShared(false), own(NUM_CONTEXTS, false),
+          tableOf(NUM_CONTEXTS, 0), prev(0) { }
+
+    /** Destructor */
+    ~ContextHCTree();
+
+    /** Get the context a symbol is coded in.
+     * @param prev the symbol coded before it.
+     * @return index of the context.
+     */
+    static int contextOf(twoBytes prev) {
+        return prev >> 8;
+    }
+
+    /** Build a table for each context used enough, and a shared table
+     * for the rest.
+     * @param freqs NUM_CONTEXTS maps of symbols and their frequency
+     *     in that context.
+     */
+    void build(const vector<unordered_map<twoBytes, int>>& freqs);
+
+    /** Encode our tables: which contexts have their own, then each tree.
+     * PRECONDITION: build() has been called.
+     * @param out our output stream for bits.
+     */
+    void writeHeader(BitOutputStream& out) const;
+
+    /** Build our tables from what writeHeader wrote.
+     * @param in our input stream for bits.
+     * @return false if the header has no table to decode with, or a bad
+     *     one.
+     */
+    bool buildFromEncoding(BitInputStream& in);
+
+    /** Write the bits coding the given symbol in the current context.
+     *  @param symbol 16 bits to be encoded.
+     *  @param out our output stream.
+     */
+    ALWAYS_INLINE void encode(twoBytes symbol, BitOutputStream& out) {
+        tables[tableOf[contextOf(prev)]]->encode(symbol, out);
+        prev = symbol;
+    }
+
+    /** Return symbol coded in the next bits in the current context.
+     *  @param in our input stream for bits.
+     *  @return symbol of the 16 bits read.
+     */
+    ALWAYS_INLINE twoBytes decode(BitInputStream& in) {
+        prev = tables[tableOf[contextOf(prev)]]->decode(in);
+        return prev;
+    }
+};
+
+#endif // CONTEXTHCTREE_HPP
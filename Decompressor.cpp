@@ -0,0 +1,214 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a Decompressor.
+ * Symbols are pairs of bytes, the first byte in the low 8 bits.
+ */
+#include <algorithm>
+#include <cstdio>
+#include "Decompressor.hpp"
+#include "Checksum.hpp"
+
+/** Decode every symbol with the given coder, writing its bytes out.
+ * Bytes are held back a block at a time. With checksums, each block is
+ * checked against the CRC32C after it, computed as the symbols go by,
+ * and only written once it matches. The first block's covers the header's
+ * count and flags too. Built into each kernel's decode loop.
+ * @param Crc how to compute the checksums.
+ * @param coder coder with a decode(BitInputStream&) method.
+ * @param bitIn our input stream for bits.
+ * @param out stream to write to.
+ * @param buffer where to hold back a block.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, CHECKSUM to read and check checksums.
+ * @param badBlock set to the block that failed its check.
+ * @return false if a block failed its check.
+ */
+template <typename Crc, typename Coder>
+static ALWAYS_INLINE bool decodeSymbols(Coder& coder, BitInputStream& bitIn,
+        ostream& out, string& buffer, unsigned int numCharacters, byte flags,
+        unsigned int& badBlock) {
+    bool checked = flags & HCTree::CHECKSUM;
+    Checksum checksum;
+    checksum.updateHeader<Crc>(numCharacters, flags);
+    unsigned int inBlock = 0;
+    unsigned int block = 0;
+    buffer.clear();
+    for (unsigned int count = 0; count < numCharacters; count += 2) {
+        unsigned short nextBytes = coder.decode(bitIn);
+        buffer += (char) nextBytes;
+        if (count + 1 < numCharacters) {
+            buffer += (char) (nextBytes >> 8);
+        }
+        if (checked) {
+            checksum.update<Crc>(nextBytes, min(numCharacters - count, 2u));
+        }
+        inBlock++;
+        // End of a block, or of the file.
+        if (inBlock == Checksum::BLOCK_SYMBOLS
+                || count + 2 >= numCharacters) {
+            if (checked && bitIn.readInt() != checksum.value()) {
+                badBlock = block;
+                return false;
+            }
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+            checksum.reset();
+            inBlock = 0;
+            block++;
+        }
+    }
+    return true;
+}
+
+/** decodeSymbols for any CPU. */
+template <typename Coder>
+static bool decodeGeneric(Coder& coder, BitInputStream& bitIn, ostream& out,
+        string& buffer, unsigned int numCharacters, byte flags,
+        unsigned int& badBlock) {
+    return decodeSymbols<SoftwareCrc>(coder, bitIn, out, buffer,
+            numCharacters, flags, badBlock);
+}
+
+/** decodeSymbols for CPUs with SSE4.2. */
+template <typename Coder>
+TARGET_SSE42 static bool decodeSse42(Coder& coder, BitInputStream& bitIn,
+        ostream& out, string& buffer, unsigned int numCharacters, byte flags,
+        unsigned int& badBlock) {
+    return decodeSymbols<HardwareCrc>(coder, bitIn, out, buffer,
+            numCharacters, flags, badBlock);
+}
+
+/** decodeSymbols for CPUs with BMI2. */
+template <typename Coder>
+TARGET_BMI2 static bool decodeBmi2(Coder& coder, BitInputStream& bitIn,
+        ostream& out, string& buffer, unsigned int numCharacters, byte flags,
+        unsigned int& badBlock) {
+    return decodeSymbols<HardwareCrc>(coder, bitIn, out, buffer,
+            numCharacters, flags, badBlock);
+}
+
+/** Decode every symbol with the given coder, writing its bytes out, in
+ * the build of the loop for the current kernel.
+ * @param coder coder with a decode(BitInputStream&) method.
+ * @param bitIn our input stream for bits.
+ * @param out stream to write to.
+ * @param numCharacters how many total characters there are.
+ * @param flags header flags, CHECKSUM to read and check checksums.
+ * @param badBlock set to the block that failed its check.
+ * @return false if a block failed its check.
+ */
+template <typename Coder>
+bool Decompressor::decodeAll(Coder& coder, BitInputStream& bitIn,
+        ostream& out, unsigned int numCharacters, byte flags,
+        unsigned int& badBlock) {
+    typedef bool (*Loop)(Coder&, BitInputStream&, ostream&, string&,
+            unsigned int, byte, unsigned int&);
+    // Indexed by BitKernel level.
+    static const Loop loops[] = {
+        decodeGeneric<Coder>, decodeSse42<Coder>, decodeBmi2<Coder>
+    };
+    return loops[BitKernel::current().level](coder, bitIn, out, buffer,
+            numCharacters, flags, badBlock);
+}
+
+/** Uncompress a file. An empty file uncompresses to an empty file.
+ * @param infile name of the compressed file.
+ * @param outfile name of the file to write.
+ * @return sizes, or why the file could not be uncompressed.
+ */
+CompressResult Decompressor::uncompress(const string& infile,
+        const string& outfile) {
+    CompressResult result = {false, "", 0, 0};
+    input.clear();
+    input.open(infile, ios_base::binary);
+    if (!input.is_open()) {
+        result.error = "cannot open " + infile;
+        return result;
+    }
+    output.clear();
+    output.open(outfile, ios_base::trunc);
+    if (!output.is_open()) {
+        input.close();
+        result.error = "cannot open " + outfile;
+        return result;
+    }
+    result = uncompress(input, output);
+    input.close();
+    output.close();
+    // Don't leave a file that is only partly right.
+    if (!result.ok) {
+        remove(outfile.c_str());
+    }
+    return result;
+}
+
+/** Uncompress everything in a stream, such as a buffer in memory.
+ * Empty input uncompresses to nothing.
+ * @param in stream to uncompress, which must be able to seek.
+ * @param out stream to write to.
+ * @return sizes, or why the input could not be uncompressed.
+ */
+CompressResult Decompressor::uncompress(istream& in, ostream& out) {
+    CompressResult result = {false, "", 0, 0};
+    in.seekg(0, ios::end);
+    streamoff size = in.tellg();
+    in.clear();
+    in.seekg(0);
+    result.inBytes = max(size, (streamoff) 0);
+    // If input is empty, don't write anything.
+    if (size <= 0) {
+        result.ok = true;
+        return result;
+    }
+    // Get the number of characters for our output.
+    BitInputStream bitIn = BitInputStream(in);
+    unsigned int numCharacters = bitIn.readInt();
+    byte flags = bitIn.readByte();
+    if (!Compressor::validFlags(flags)) {
+        result.error = "bad header, invalid flags";
+        return result;
+    }
+    bool ok;
+    unsigned int badBlock = 0;
+    if (flags & HCTree::ADAPTIVE) {
+        // Adaptive coding, rebuild the tree as we decode.
+        adaptive.reset();
+        ok = decodeAll(adaptive, bitIn, out, numCharacters, flags,
+                badBlock);
+    } else if (flags & HCTree::ORDER1) {
+        // Order-1 coding, read every context's table first.
+        if (!context.buildFromEncoding(bitIn)) {
+            result.error = "bad header, no usable context tables";
+            return result;
+        }
+        ok = decodeAll(context, bitIn, out, numCharacters, flags,
+                badBlock);
+    } else {
+        tree.reset();
+        // Sampled trees may escape symbols missing from the sample.
+        if ((flags & HCTree::SAMPLED) && bitIn.readBit()) {
+            tree.setEscape(bitIn.readShort());
+        }
+        // Build our tree from encoding. A lone symbol is coded in no bits.
+        if (!tree.readTree(bitIn)) {
+            result.error = "bad header, not a tree";
+            return result;
+        }
+        ok = decodeAll(tree, bitIn, out, numCharacters, flags, badBlock);
+    }
+    // The codes must end in the last byte. A flag turned off or on, say
+    // checking, leaves words over or runs out.
+    unsigned long long used = (bitIn.bitsTaken() + CHAR_BIT - 1) / CHAR_BIT;
+    if (!ok) {
+        result.error = "Checksum mismatch in block " + to_string(badBlock);
+    } else if (used != (unsigned long long) size) {
+        result.error = "coded data ends at byte " + to_string(used)
+                + " of " + to_string(size);
+    } else if (!out.good()) {
+        result.error = "cannot write";
+    }
+    result.outBytes = numCharacters;
+    result.ok = result.error.empty();
+    return result;
+}
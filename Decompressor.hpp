@@ -0,0 +1,60 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a Decompressor.
+ * Uncompresses what a Compressor wrote with any engine, keeping its trees
+ * around so one Decompressor can do many files without setting up.
+ */
+#ifndef DECOMPRESSOR_HPP
+#define DECOMPRESSOR_HPP
+
+#include "Compressor.hpp"
+
+/** Uncompresses files or buffers, reusing its trees from one to the next.
+ *  Not thread safe, use one per thread.
+ *  @input stream of the file being uncompressed.
+ *  @output stream of the file being written.
+ *  @tree, @adaptive, @context the engines, rebuilt for each input.
+ *  @buffer decoded bytes of the block not yet written out.
+ */
+class Decompressor {
+private:
+    ifstream input;
+    ofstream output;
+    HCTree tree;
+    AdaptiveHCTree adaptive;
+    ContextHCTree context;
+    string buffer;
+
+    /** Decode every symbol with the given coder, writing its bytes out,
+     * in the build of the loop for the current kernel.
+     * @param coder coder with a decode(BitInputStream&) method.
+     * @param bitIn our input stream for bits.
+     * @param out stream to write to.
+     * @param numCharacters how many total characters there are.
+     * @param flags header flags, CHECKSUM to read and check checksums.
+     * @param badBlock set to the block that failed its check.
+     * @return false if a block failed its check.
+     */
+    template <typename Coder>
+    bool decodeAll(Coder& coder, BitInputStream& bitIn, ostream& out,
+            unsigned int numCharacters, byte flags, unsigned int& badBlock);
+
+public:
+    /** Uncompress a file. An empty file uncompresses to an empty file.
+     * @param infile name of the compressed file.
+     * @param outfile name of the file to write.
+     * @return sizes, or why the file could not be uncompressed.
+     */
+    CompressResult uncompress(const string& infile, const string& outfile);
+
+    /** Uncompress everything in a stream, such as a buffer in memory.
+     * Empty input uncompresses to nothing.
+     * @param in stream to uncompress, which must be able to seek.
+     * @param out stream to write to.
+     * @return sizes, or why the input could not be uncompressed.
+     */
+    CompressResult uncompress(istream& in, ostream& out);
+};
+
+#endif // DECOMPRESSOR_HPP
@@ -0,0 +1,159 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a Frame.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Frame.hpp"
+
+const byte Frame::COMPRESS;
+const byte Frame::UNCOMPRESS;
+const byte Frame::OK;
+const byte Frame::ERROR;
+const unsigned int Frame::MAX_PAYLOAD;
+
+/** Size of op, flags and length. */
+static const int HEADER_BYTES = 6;
+/** Frames up to this payload size are sent with a single write. */
+static const unsigned int SMALL_PAYLOAD = 4096;
+
+/**
+ * Read exactly length bytes, however the socket splits them up.
+ * @param fd socket to read from.
+ * @param data where to put them.
+ * @param length how many bytes to read.
+ * @return false if the socket closed first.
+ */
+static bool readFully(int fd, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t got = ::read(fd, data, length);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        length -= got;
+    }
+    return true;
+}
+
+/**
+ * Write exactly length bytes. A closed peer is an error, not a SIGPIPE.
+ * @param fd socket to write to.
+ * @param data the bytes.
+ * @param length how many bytes to write.
+ * @return false if the socket closed first.
+ */
+static bool writeFully(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+/**
+ * Get the payload length out of a frame's header.
+ * @param header the op, flags and length bytes.
+ * @return the length.
+ */
+static unsigned int lengthOf(const unsigned char* header) {
+    return header[2] | (header[3] << 8) | (header[4] << 16)
+            | ((unsigned int) header[5] << 24);
+}
+
+/** Read the next frame, reusing the payload's space.
+ * @param fd socket to read from.
+ * @return false if the socket closed or sent too big a frame.
+ */
+bool Frame::read(int fd) {
+    unsigned char header[HEADER_BYTES];
+    if (!readFully(fd, (char*) header, HEADER_BYTES)) {
+        return false;
+    }
+    op = header[0];
+    flags = header[1];
+    unsigned int length = lengthOf(header);
+    if (length > MAX_PAYLOAD) {
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || readFully(fd, &payload[0], length);
+}
+
+/** Read whatever has arrived of the next frame, without waiting.
+ * Until the frame is all in, payload holds the bytes so far, the
+ * op, flags and length first. It only grows as bytes arrive, so a
+ * header claiming a big payload costs nothing until it is sent.
+ * PRECONDITION: payload was empty when the frame began.
+ * @param fd socket to read from.
+ * @param done set to whether the whole frame is in.
+ * @return false if the socket closed or sent too big a frame.
+ */
+bool Frame::readSome(int fd, bool& done) {
+    char chunk[SMALL_PAYLOAD];
+    done = false;
+    while (true) {
+        size_t want = HEADER_BYTES;
+        if (payload.size() >= HEADER_BYTES) {
+            unsigned int length =
+                    lengthOf((const unsigned char*) payload.data());
+            if (length > MAX_PAYLOAD) {
+                return false;
+            }
+            want += length;
+        }
+        if (payload.size() >= HEADER_BYTES && payload.size() == want) {
+            op = payload[0];
+            flags = payload[1];
+            payload.erase(0, HEADER_BYTES);
+            done = true;
+            return true;
+        }
+        // Never past this frame, the next one is read when its turn comes.
+        ssize_t got = recv(fd, chunk, min(want - payload.size(),
+                sizeof(chunk)), MSG_DONTWAIT);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true; // The rest has yet to come.
+        }
+        if (got <= 0) {
+            return false;
+        }
+        payload.append(chunk, got);
+    }
+}
+
+/** Write this frame.
+ * @param fd socket to write to.
+ * @return false if the socket closed.
+ */
+bool Frame::write(int fd) const {
+    unsigned int length = payload.size();
+    unsigned char header[HEADER_BYTES] = {op, flags,
+        (unsigned char) length, (unsigned char) (length >> 8),
+        (unsigned char) (length >> 16), (unsigned char) (length >> 24)};
+    // Small frames go out in one send, so the peer wakes up once.
+    if (length <= SMALL_PAYLOAD) {
+        char data[HEADER_BYTES + SMALL_PAYLOAD];
+        copy(header, header + HEADER_BYTES, data);
+        copy(payload.begin(), payload.end(), data + HEADER_BYTES);
+        return writeFully(fd, data, HEADER_BYTES + length);
+    }
+    return writeFully(fd, (const char*) header, HEADER_BYTES)
+            && writeFully(fd, payload.data(), length);
+}
@@ -0,0 +1,58 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file for the messages the daemon and its clients send over a
+ * Unix domain socket. Each frame is an op byte, a flags byte, the payload
+ * length in 4 bytes, first byte lowest, then the payload.
+ */
+#ifndef FRAME_HPP
+#define FRAME_HPP
+
+#include <string>
+#include "HCNode.hpp"
+
+/** One request or response.
+ * @op what to do, or how it went.
+ * @flags header flags for compressing, as from Compressor::parseOption.
+ * @payload the bytes to work on, the result, or an error message.
+ */
+struct Frame {
+    byte op;
+    byte flags;
+    string payload;
+
+    /** Request to compress the payload. */
+    const static byte COMPRESS = 'c';
+    /** Request to uncompress the payload. */
+    const static byte UNCOMPRESS = 'u';
+    /** Response holding the result. */
+    const static byte OK = 'k';
+    /** Response holding why the request failed. */
+    const static byte ERROR = 'e';
+    /** Largest payload either side will take. */
+    const static unsigned int MAX_PAYLOAD = 256 << 20;
+
+    /** Read the next frame, reusing the payload's space.
+     * @param fd socket to read from.
+     * @return false if the socket closed or sent too big a frame.
+     */
+    bool read(int fd);
+
+    /** Read whatever has arrived of the next frame, without waiting.
+     * Until the frame is all in, payload holds the bytes so far, the
+     * op, flags and length first.
+     * PRECONDITION: payload was empty when the frame began.
+     * @param fd socket to read from.
+     * @param done set to whether the whole frame is in.
+     * @return false if the socket closed or sent too big a frame.
+     */
+    bool readSome(int fd, bool& done);
+
+    /** Write this frame.
+     * @param fd socket to write to.
+     * @return false if the socket closed.
+     */
+    bool write(int fd) const;
+};
+
+#endif // FRAME_HPP
@@ -0,0 +1,96 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a HCClient.
+ */
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "HCClient.hpp"
+
+/** Destructor, hangs up. */
+HCClient::~HCClient() {
+    disconnect();
+}
+
+/** Connect to a daemon, hanging up on any earlier one.
+ * @param path where the daemon's socket is bound.
+ * @return false if there is no daemon there.
+ */
+bool HCClient::connect(const string& path) {
+    disconnect();
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, (struct sockaddr*) &address, sizeof(address)) != 0) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+/** Compress a buffer, as ./compress would a file holding it.
+ * @param data the bytes to compress.
+ * @param flags header flags, as from Compressor::parseOption.
+ * @param result set to the compressed bytes, or why there are none.
+ * @return false if the request failed.
+ */
+bool HCClient::compress(const string& data, byte flags, string& result) {
+    return call(Frame::COMPRESS, flags, data, result);
+}
+
+/** Uncompress a buffer, as ./uncompress would a file holding it.
+ * @param data the compressed bytes.
+ * @param result set to the bytes, or why there are none.
+ * @return false if the request failed.
+ */
+bool HCClient::uncompress(const string& data, string& result) {
+    return call(Frame::UNCOMPRESS, 0, data, result);
+}
+
+/** Send a request and wait for its response.
+ * @param op Frame::COMPRESS or Frame::UNCOMPRESS.
+ * @param flags header flags for compressing.
+ * @param data the bytes to work on.
+ * @param result set to the result, or why there is none.
+ * @return false if the request failed.
+ */
+bool HCClient::call(byte op, byte flags, const string& data,
+        string& result) {
+    if (fd < 0) {
+        result = "not connected";
+        return false;
+    }
+    if (data.size() > Frame::MAX_PAYLOAD) {
+        result = "too big to send";
+        return false;
+    }
+    request.op = op;
+    request.flags = flags;
+    request.payload = data;
+    if (!request.write(fd) || !response.read(fd)) {
+        disconnect();
+        result = "connection closed";
+        return false;
+    }
+    // Swap so both strings keep their space for next time.
+    result.swap(response.payload);
+    return response.op == Frame::OK;
+}
+
+/** Hang up. */
+void HCClient::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a HCClient.
+ * Client side of the daemon: sends buffers to compress or uncompress over
+ * one kept open connection, and waits for each result.
+ */
+#ifndef HCCLIENT_HPP
+#define HCCLIENT_HPP
+
+#include "Frame.hpp"
+
+/** One connection to a daemon. Requests on it are served one at a time,
+ *  in order. Not thread safe, use one per thread.
+ *  @fd the connection, -1 if not connected.
+ *  @request, @response frames kept to reuse their space.
+ */
+class HCClient {
+private:
+    int fd;
+    Frame request;
+    Frame response;
+
+    /** Send a request and wait for its response.
+     * @param op Frame::COMPRESS or Frame::UNCOMPRESS.
+     * @param flags header flags for compressing.
+     * @param data the bytes to work on.
+     * @param result set to the result, or why there is none.
+     * @return false if the request failed.
+     */
+    bool call(byte op, byte flags, const string& data, string& result);
+
+public:
+    /** Constructor, not connected. */
+    HCClient() : fd(-1) { }
+
+    /** Destructor, hangs up. */
+    ~HCClient();
+
+    /** Connect to a daemon, hanging up on any earlier one.
+     * @param path where the daemon's socket is bound.
+     * @return false if there is no daemon there.
+     */
+    bool connect(const string& path);
+
+    /** Compress a buffer, as ./compress would a file holding it.
+     * @param data the bytes to compress.
+     * @param flags header flags, as from Compressor::parseOption.
+     * @param result set to the compressed bytes, or why there are none.
+     * @return false if the request failed.
+     */
+    bool compress(const string& data, byte flags, string& result);
+
+    /** Uncompress a buffer, as ./uncompress would a file holding it.
+     * @param data the compressed bytes.
+     * @param result set to the bytes, or why there are none.
+     * @return false if the request failed.
+     */
+    bool uncompress(const string& data, string& result);
+
+    /** Hang up. */
+    void disconnect();
+};
+
+#endif // HCCLIENT_HPP
@@ -0,0 +1,272 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Implementation of a HCDaemon.
+ */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "HCDaemon.hpp"
+
+/** Destructor, stops and closes the socket. */
+HCDaemon::~HCDaemon() {
+    stop();
+    for (thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    if (listener >= 0) {
+        close(listener);
+    }
+    for (int fd : wake) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+/** Bind the socket and start the workers.
+ * A socket left behind by a daemon that did not stop cleanly is replaced.
+ * @param error set to why not, if we could not.
+ * @return false if the socket could not be bound.
+ */
+bool HCDaemon::start(string& error) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        error = "socket path too long: " + path;
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        error = "cannot create socket";
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0
+            || listen(listener, SOMAXCONN) != 0) {
+        error = "cannot bind " + path + ": " + strerror(errno);
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    // Neither end may block: a full pipe already means run() will wake.
+    if (pipe(wake) != 0 || fcntl(wake[0], F_SETFL, O_NONBLOCK) != 0
+            || fcntl(wake[1], F_SETFL, O_NONBLOCK) != 0) {
+        error = string("cannot create pipe: ") + strerror(errno);
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    for (unsigned int i = 0; i < numWorkers; i++) {
+        workers.push_back(thread(&HCDaemon::work, this));
+    }
+    return true;
+}
+
+/** Accept connections and poll them for requests until stop() is
+ * called, then wait for the workers to finish and remove the socket.
+ * Requests are read here a piece at a time, as they arrive, and only
+ * whole ones go to the workers. A connection is only polled between
+ * requests, so one is answered before the next is read from it.
+ * PRECONDITION: start() succeeded.
+ */
+void HCDaemon::run() {
+    vector<pollfd> polled;
+    vector<int> complete;
+    // A client that stops reading its response can't hold a worker.
+    struct timeval timeout = {SEND_TIMEOUT, 0};
+    while (true) {
+        polled.clear();
+        polled.push_back({listener, POLLIN, 0});
+        polled.push_back({wake[0], POLLIN, 0});
+        for (int fd : idle) {
+            polled.push_back({fd, POLLIN, 0});
+        }
+        if (poll(polled.data(), polled.size(), -1) < 0 && errno != EINTR) {
+            break;
+        }
+        if (polled[1].revents != 0) {
+            char drained[64];
+            while (read(wake[0], drained, sizeof(drained)) > 0) { }
+        }
+        // Read what has arrived, hanging up on clients that hung up.
+        idle.clear();
+        complete.clear();
+        for (size_t i = 2; i < polled.size(); i++) {
+            int fd = polled[i].fd;
+            bool done = false;
+            if (polled[i].revents == 0) {
+                idle.push_back(fd);
+            } else if (!partial[fd].readSome(fd, done)) {
+                partial.erase(fd);
+                close(fd);
+            } else if (done) {
+                complete.push_back(fd);
+            } else {
+                idle.push_back(fd);
+            }
+        }
+        unique_lock<mutex> guard(lock);
+        if (stopping) {
+            idle.insert(idle.end(), complete.begin(), complete.end());
+            break;
+        }
+        for (int fd : complete) {
+            waiting.push(make_pair(fd, move(partial[fd])));
+            partial.erase(fd);
+            ready.notify_one();
+        }
+        // Connections done with a request are polled again.
+        idle.insert(idle.end(), returned.begin(), returned.end());
+        returned.clear();
+        guard.unlock();
+        if (polled[0].revents != 0) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0) {
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                        sizeof(timeout));
+                idle.push_back(fd);
+            }
+        }
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    // Clients no worker is serving are hung up on.
+    for (int fd : idle) {
+        close(fd);
+    }
+    for (int fd : returned) {
+        close(fd);
+    }
+    while (!waiting.empty()) {
+        close(waiting.front().first);
+        waiting.pop();
+    }
+    partial.clear();
+    unlink(path.c_str());
+}
+
+/** Stop accepting and hang up on every client. Safe to call from
+ * another thread while run() is polling.
+ */
+void HCDaemon::stop() {
+    lock_guard<mutex> guard(lock);
+    if (stopping) {
+        return;
+    }
+    stopping = true;
+    // Wakes the poll, and every worker blocked sending a response.
+    wakeUp();
+    for (int fd : serving) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    ready.notify_all();
+}
+
+/** Wake the poll in run(). */
+void HCDaemon::wakeUp() {
+    if (wake[1] >= 0) {
+        char signal = 0;
+        // A full pipe will wake it anyway.
+        if (write(wake[1], &signal, 1) < 0) {
+            return;
+        }
+    }
+}
+
+/** Take requests and serve them until we stop.
+ * The Compressor and Decompressor live as long as the worker, so their
+ * trees and tables are only allocated once.
+ */
+void HCDaemon::work() {
+    Compressor compressor;
+    Decompressor decompressor;
+    pair<int, Frame> request;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            while (waiting.empty() && !stopping) {
+                ready.wait(guard);
+            }
+            if (stopping) {
+                return;
+            }
+            request = move(waiting.front());
+            waiting.pop();
+            serving.insert(request.first);
+        }
+        int fd = request.first;
+        bool open = serve(fd, request.second, compressor, decompressor);
+        lock_guard<mutex> guard(lock);
+        serving.erase(fd);
+        if (open) {
+            returned.push_back(fd);
+            wakeUp();
+        } else {
+            close(fd);
+        }
+    }
+}
+
+/** Serve a request and send the response.
+ * Each request gets exactly one response: the result, or an error.
+ * @param fd the connection it came on.
+ * @param request the request.
+ * @param compressor this worker's Compressor.
+ * @param decompressor this worker's Decompressor.
+ * @return false if the client hung up or stopped reading.
+ */
+bool HCDaemon::serve(int fd, const Frame& request, Compressor& compressor,
+        Decompressor& decompressor) {
+    // Kept between requests so their buffers are reused.
+    thread_local Frame response;
+    thread_local istringstream in;
+    thread_local ostringstream out;
+    in.str(request.payload);
+    in.clear();
+    out.str("");
+    out.clear();
+    CompressResult result = {false, "", 0, 0};
+    if (request.op == Frame::COMPRESS) {
+        if (Compressor::validFlags(request.flags)) {
+            result = compressor.compress(in, out, request.flags);
+        } else {
+            result.error = "invalid flags";
+        }
+    } else if (request.op == Frame::UNCOMPRESS) {
+        // The header's character count, so garbage can't make us
+        // write more than a response can hold.
+        const string& data = request.payload;
+        unsigned int numCharacters = 0;
+        for (size_t i = 0; i < sizeof(int) && i < data.size(); i++) {
+            numCharacters |= (unsigned int) (byte) data[i] << (8 * i);
+        }
+        if (numCharacters > Frame::MAX_PAYLOAD) {
+            result.error = "too big to uncompress";
+        } else {
+            result = decompressor.uncompress(in, out);
+        }
+    } else {
+        result.error = "unknown request";
+    }
+    response.flags = 0;
+    if (result.ok) {
+        response.op = Frame::OK;
+        response.payload = out.str();
+    } else {
+        response.op = Frame::ERROR;
+        response.payload = result.error;
+    }
+    return response.write(fd);
+}
@@ -0,0 +1,108 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Header file representing a HCDaemon.
+ * Serves compress and uncompress requests from other processes over a
+ * Unix domain socket, so they pay for neither a process nor a cold start.
+ */
+#ifndef HCDAEMON_HPP
+#define HCDAEMON_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "Decompressor.hpp"
+#include "Frame.hpp"
+
+/** Accepts connections and polls them, reading requests without waiting
+ *  and handing each whole one to a pool of worker threads, so any number
+ *  of clients share the workers and a slow one holds none of them. A
+ *  worker keeps its Compressor, Decompressor and buffers warm across
+ *  requests and serves one request at a time.
+ *  @path where the socket is bound.
+ *  @listener the listening socket, -1 until started.
+ *  @wake pipe workers and stop() write to, to wake the poll in run().
+ *  @numWorkers how many worker threads to run.
+ *  @workers the worker threads.
+ *  @idle connections between requests, only run() touches these.
+ *  @partial what has arrived of each idle connection's next request,
+ *      only run() touches these.
+ *  @lock guards waiting, returned, serving and stopping.
+ *  @ready signalled when there is a request to serve, or we stop.
+ *  @waiting connections with a whole request no worker has taken yet.
+ *  @returned connections a worker is done with, to poll again.
+ *  @serving connections a worker is serving.
+ *  @stopping whether stop() has been called.
+ */
+class HCDaemon {
+private:
+    string path;
+    int listener;
+    int wake[2];
+    unsigned int numWorkers;
+    vector<thread> workers;
+    vector<int> idle;
+    unordered_map<int, Frame> partial;
+    mutex lock;
+    condition_variable ready;
+    queue<pair<int, Frame>> waiting;
+    vector<int> returned;
+    unordered_set<int> serving;
+    bool stopping;
+
+    /** Take requests and serve them until we stop. */
+    void work();
+
+    /** Serve a request and send the response.
+     * @param fd the connection it came on.
+     * @param request the request.
+     * @param compressor this worker's Compressor.
+     * @param decompressor this worker's Decompressor.
+     * @return false if the client hung up or stopped reading.
+     */
+    bool serve(int fd, const Frame& request, Compressor& compressor,
+            Decompressor& decompressor);
+
+    /** Wake the poll in run(). */
+    void wakeUp();
+
+public:
+    /** Longest a worker waits for a client to take a response, in
+     * seconds, before hanging up on it.
+     */
+    const static int SEND_TIMEOUT = 10;
+
+    /** Constructor, nothing is bound until start().
+     * @param path where to bind the socket.
+     * @param numWorkers how many worker threads to run, at least one.
+     */
+    HCDaemon(const string& path, unsigned int numWorkers)
+        : path(path), listener(-1), wake{-1, -1},
+          numWorkers(max(numWorkers, 1u)), stopping(false) { }
+
+    /** Destructor, stops and closes the socket. */
+    ~HCDaemon();
+
+    /** Bind the socket and start the workers.
+     * @param error set to why not, if we could not.
+     * @return false if the socket could not be bound.
+     */
+    bool start(string& error);
+
+    /** Accept connections and poll them for requests until stop() is
+     * called, then wait for the workers to finish and remove the socket.
+     * PRECONDITION: start() succeeded.
+     */
+    void run();
+
+    /** Stop accepting and hang up on every client. Safe to call from
+     * another thread while run() is polling.
+     */
+    void stop();
+};
+
+#endif // HCDAEMON_HPP
@@ -16,7 +16,8 @@ using namespace std;
 /**
  * A class, instances of which are nodes in an HCTree.
  * @count How frequent the symbol occurs.
- * @symbol Byte in the file we're keeping track of.
+ * @symbol Byte in the file we're keeping track of. For a node built from
+ *     two others, the smallest symbol under it.
  * @c0 Pointer to '0' child.
  * @c1 Pointer to '1' child.
  * @p Pointer to parent.
@@ -50,7 +51,8 @@ public:
          if (this->count != other.count) {
              return this->count > other.count;
          }
-         // Counts are equal. use symbol value to break tie.
+         // Counts are equal. use symbol value to break tie, which is
+         // unique among nodes not yet joined.
          return this->symbol < other.symbol;
      }
 };
@@ -5,16 +5,17 @@
  * Methods for numerous encode and decodes for a naive approach, also
  * space efficient implementations, as well as building the tree.
  */
+#include <algorithm>
 #include "HCTree.hpp"
 
 /** Use the Huffman algorithm to build a Huffman coding trie.
  * PRECONDITION: freqs is a vector of ints, such that freqs[i] is
  * the frequency of occurrence of byte i in the message.
  * POSTCONDITION: root points to the root of the trie,
- * and leaves[i] points to the leaf node containing byte i.
+ * and codes[i] holds the code of each symbol i in it.
  * @param freqs vector of ascii values and their frequency.
  */
-void HCTree::build(const unordered_map<twoBytes, int> freqs) {
+void HCTree::build(const unordered_map<twoBytes, int>& freqs) {
     // Create our priority queue as a min-heap and add our freqs to it.
     priority_queue<HCNode*, vector<HCNode*>, HCNodePtrComp> q;
     for (auto freq : freqs) {
@@ -27,21 +28,18 @@ void HCTree::build(const unordered_map<twoBytes, int> freqs) {
     HCNode* n1;
     // Begin building the Huffman trie.
     if (q.size() == 1) { // File contains one character.
-        root = new HCNode(1, q.top()->symbol);
+        root = q.top();
     }
     while (q.size() > 1) {
         n0 = q.top();
         q.pop();
         n1 = q.top();
         q.pop();
-        root = new HCNode(n0->count + n1->count, '\0');
+        // Named for the smallest symbol under it, so no two nodes in the
+        // queue tie and the tree doesn't depend on the order of freqs.
+        root = new HCNode(n0->count + n1->count,
+                min(n0->symbol, n1->symbol));
         // Set pointers.
-        if (n0->c0 == nullptr && n0->c1 == nullptr) {
-            leaves[n0->symbol] = n0;
-        }
-        if (n1->c0 == nullptr && n1->c1 == nullptr) {
-            leaves[n1->symbol] = n1;
-        }
         root->c0 = n0;
         n0->p = root;
         root->c1 = n1;
@@ -49,36 +47,40 @@ void HCTree::build(const unordered_map<twoBytes, int> freqs) {
         q.push(root);
     }
     // Get the codes for our leaves.
-    HCNode* curr;
-    HCNode* prev;
-    for (HCNode* leaf : leaves) {
-        string code;
-        if (leaf != nullptr) {
-            curr = leaf;
-            while (curr->p != nullptr) {
-                prev = curr;
-                curr = curr->p;
-                if (curr->c0 == prev) {
-                    code.insert(0, "0"); // Prepend.
-                } else {
-                    code.insert(0, "1"); // Prepend.
-                }
-            }
-            codes[leaf->symbol] = code;
-//            cout << leaf->count << " : " << codes.at(leaf->symbol) << endl;
-        }
+    if (root != nullptr) {
+        assignCodes(root, 0, 0);
     }
+    buildDecodeTable();
+}
+
+/** Give every leaf under a node its code, walking down from the root.
+ * @param node the node.
+ * @param bits the code of node, the bit nearest the root lowest.
+ * @param length how many bits the code of node has.
+ */
+void HCTree::assignCodes(HCNode* node, unsigned long long bits,
+        unsigned int length) {
+    if (node->c0 == nullptr && node->c1 == nullptr) {
+        Code code = {bits, length};
+        codes[node->symbol] = code;
+        return;
+    }
+    // Append, the bit nearest the root goes out first.
+    assignCodes(node->c0, bits, length + 1);
+    assignCodes(node->c1, bits | (1ull << length), length + 1);
 }
 
 /** Use our encoding to build a Huffman coding trie.
- * PRECONDITION: a file was properly encoded.
  * @param in our input stream for bits.
+ * @return false if the input ran out or the trie is deeper than
+ *     MAX_DEPTH, so it was not properly encoded.
  */
-void HCTree::buildFromEncoding(BitInputStream& in) {
+bool HCTree::buildFromEncoding(BitInputStream& in) {
     int bit;
     bit = in.readBit();
     root = new HCNode(bit, '\0');
     HCNode* curr = root;
+    unsigned int depth = 0;
     while (true) {
         // Get to a node where we can set its children.
         while (curr->c0 != nullptr && curr->c1 != nullptr) {
@@ -86,10 +88,15 @@ void HCTree::buildFromEncoding(BitInputStream& in) {
             if (curr == nullptr) {
                 break;
             }
+            depth--;
         }
         if (curr == nullptr) {
             break;
         }
+        // Garbage can go deeper than any code, or run past the end.
+        if (depth == MAX_DEPTH || in.hitEnd()) {
+            return false;
+        }
         bit = in.readBit();
         // Create new node.
         if (bit == 0) {
@@ -102,6 +109,7 @@ void HCTree::buildFromEncoding(BitInputStream& in) {
                 curr->c1 = newNode;
                 curr = curr->c1;
             }
+            depth++;
         } else {
             twoBytes symbol = in.readShort();
             HCNode* newNode = new HCNode(bit, symbol);
@@ -113,19 +121,43 @@ void HCTree::buildFromEncoding(BitInputStream& in) {
             }
         }
     }
+    if (in.hitEnd()) {
+        return false;
+    }
+    buildDecodeTable();
+    return true;
+}
+
+/** Code symbols that are not in the tree as this symbol's code
+ * followed by the raw symbol.
+ * PRECONDITION: escape is not in the frequencies given to build().
+ * @param symbol the escape symbol.
+ */
+void HCTree::setEscape(twoBytes symbol) {
+    hasEscape = true;
+    escape = symbol;
 }
 
 /** Encode this tree with pre-order traversal.
  * PRECONDITION: build() has been called, to create the coding
- * tree, and initialize root pointer and leaves vector.
+ * tree, and initialize root pointer and codes.
  * @param out our input stream for bits.
  * @param numCharacters how many total characters there are.
  * @param numUniqueChars how many different ascii values there are.
+ * @param flags header flags, such as SAMPLED.
  */
-void HCTree::writeHeader(BitOutputStream& out,
-        unsigned int numCharacters, unsigned int numUniqueChars) const
+void HCTree::writeHeader(BitOutputStream& out, unsigned int numCharacters,
+        unsigned int numUniqueChars, byte flags) const
 {
     out.writeInt(numCharacters);
+    out.writeByte(flags);
+    // Sampled trees say if, and with what, missing symbols are escaped.
+    if (flags & SAMPLED) {
+        out.writeBit(hasEscape);
+        if (hasEscape) {
+            out.writeShort(escape);
+        }
+    }
     // One character case.
     if (numUniqueChars == 1) {
         out.writeBit(1);
@@ -136,6 +168,35 @@ void HCTree::writeHeader(BitOutputStream& out,
     }
 }
 
+/** Encode just this tree: a symbol if it is the only one,
+ * else the pre-order traversal.
+ * PRECONDITION: build() has been called with at least one symbol.
+ * @param out our output stream for bits.
+ */
+void HCTree::writeTree(BitOutputStream& out) const {
+    if (root->c0 == nullptr && root->c1 == nullptr) {
+        out.writeBit(1);
+        out.writeShort(root->symbol);
+    } else {
+        out.writeBit(0);
+        writeHeaderHelper(out, root);
+    }
+}
+
+/** Build a Huffman coding trie written by writeTree.
+ * @param in our input stream for bits.
+ * @return false if what was read is not a trie writeTree wrote.
+ */
+bool HCTree::readTree(BitInputStream& in) {
+    if (in.readBit() == 1) {
+        // Lone symbol, decoded from zero bits.
+        root = new HCNode(1, in.readShort());
+        buildDecodeTable();
+        return !in.hitEnd();
+    }
+    return buildFromEncoding(in);
+}
+
 /** Helper for writeHeader.
  * @param out our input stream for bits.
  * @param parent root to be handed for recursion.
@@ -156,20 +217,6 @@ void HCTree::writeHeaderHelper(BitOutputStream& out, HCNode* parent) const {
     writeHeaderHelper(out, parent->c1);
 }
 
-/** Write to the given BitOutputStream.
- *  the sequence of bits coding the given symbol.
- *  PRECONDITION: build() has been called, to create the coding
- *  tree, and initialize root pointer and leaves vector.
- *  @param symbol 8 bits to be encoded.
- *  @param out our output stream.
- */
-void HCTree::encode(twoBytes symbol, BitOutputStream& out) const {
-    string code = codes.at(symbol);
-    for (char& bit : code) {
-        out.writeBit((unsigned int) (bit - CHAR_TO_INT));
-    }
-}
-
 /** Make sure we get the last byte in.
  * @param out our input stream for bits.
  */
@@ -177,28 +224,66 @@ void HCTree::pad(BitOutputStream& out) const {
     out.pad();
 }
 
-/** Return symbol coded in the next sequence of bits from the stream.
- *  PRECONDITION: build() has been called, to create the coding
- *  tree, and initialize root pointer and leaves vector.
- *  @param in our input stream for bits.
- *  @return symbol of the 8 bits read.
+/** How many bits the longest code under a node has.
+ * @param node the node.
+ * @return its height, 0 for a leaf.
  */
-unsigned short HCTree::decode(BitInputStream& in) const {
-    int nextBit;
-    if (root == nullptr) { // Empty file case.
+static unsigned int heightOf(const HCNode* node) {
+    if (node->c0 == nullptr || node->c1 == nullptr) {
         return 0;
     }
-    // Else we have an ordinary file.
-    HCNode* curr = root; // TODO: Use leaves instead.
-    while (curr->c0 != nullptr && curr->c1 != nullptr) { // Not a leaf:
-        nextBit = in.readBit();
-        if (nextBit == 0) {
-            curr = curr->c0;
-        } else {
-            curr = curr->c1;
-        }
+    return 1 + max(heightOf(node->c0), heightOf(node->c1));
+}
+
+/** Build decodeTable for the current tree. Shallow trees get a table
+ * only as big as their longest code needs.
+ */
+void HCTree::buildDecodeTable() {
+    decodeBits = 0;
+    decodeTable.clear();
+    if (root == nullptr) {
+        return;
+    }
+    // A lone symbol is coded in no bits, and needs no table.
+    decodeBits = heightOf(root);
+    if (decodeBits > DECODE_BITS) {
+        decodeBits = DECODE_BITS;
+    }
+    if (decodeBits > 0) {
+        decodeTable.resize(1u << decodeBits);
+        fillDecodeTable(root, 0, 0);
+    }
+}
+
+/** Point every entry of decodeTable whose bits start with the code
+ * of a node at it, or at the leaf below it they code.
+ * @param node the node.
+ * @param bits the code of node, the bit nearest the root lowest.
+ * @param length how many bits the code of node has.
+ */
+void HCTree::fillDecodeTable(const HCNode* node, unsigned int bits,
+        unsigned int length) {
+    if (length < decodeBits && node->c0 != nullptr && node->c1 != nullptr) {
+        fillDecodeTable(node->c0, bits, length + 1);
+        fillDecodeTable(node->c1, bits | (1u << length), length + 1);
+        return;
+    }
+    // Whatever the peeked bits after the code are, they lead here.
+    DecodeStep step = {node, length};
+    for (unsigned int rest = 0; rest < (1u << (decodeBits - length));
+            rest++) {
+        decodeTable[bits | (rest << length)] = step;
     }
-    return curr->symbol;
+}
+
+/** Empty the tree so it can be built again. */
+void HCTree::reset() {
+    deleteAll(root);
+    root = nullptr;
+    codes.clear();
+    hasEscape = false;
+    decodeBits = 0;
+    decodeTable.clear();
 }
 
 /** Destructor */
@@ -32,56 +32,151 @@ public:
     }
 };
 
+/** A symbol's code, packed to be written in one go.
+ *  @bits the code, the bit nearest the root lowest, as streams write it.
+ *  @length how many bits. Counts that fit an int give codes under
+ *      46 bits, a Fibonacci-shaped tree being the deepest.
+ */
+struct Code {
+    unsigned long long bits;
+    unsigned int length;
+};
+
+/** Where peeking some bits gets decode() to.
+ *  @node the leaf the bits code, or the node to go on from if no code
+ *      fits in them.
+ *  @length how many of the bits lead to node.
+ */
+struct DecodeStep {
+    const HCNode* node;
+    unsigned int length;
+};
+
 /** A Huffman Code Tree class.
  *  Not very generic: Use only if alphabet consists
  *  of unsigned chars.
  *  @root the root of the trie.
- *  @leaves nodes where we have a symbol represented.
  *  @codes what the leaf would traverse to from root.
+ *  @hasEscape whether symbols missing from the tree can be coded.
+ *  @escape symbol whose code precedes a raw (16) bit missing symbol.
+ *  @decodeBits how many bits decode() peeks at, 0 for no decodeTable.
+ *  @decodeTable where each value of the peeked bits leads.
  */
 class HCTree {
 private:
     HCNode* root;
-    vector<HCNode*> leaves;
-    unordered_map<twoBytes, string> codes;
-    const int CHAR_TO_INT = 48;
+    unordered_map<twoBytes, Code> codes;
+    bool hasEscape;
+    twoBytes escape;
+    unsigned int decodeBits;
+    vector<DecodeStep> decodeTable;
 
     void deleteAll(HCNode* start);
 
+    /** Build decodeTable for the current tree. */
+    void buildDecodeTable();
+
+    /** Point every entry of decodeTable whose bits start with the code
+     * of a node at it, or at the leaf below it they code.
+     * @param node the node.
+     * @param bits the code of node, the bit nearest the root lowest.
+     * @param length how many bits the code of node has.
+     */
+    void fillDecodeTable(const HCNode* node, unsigned int bits,
+            unsigned int length);
+
+    /** Give every leaf under a node its code, walking down from the root.
+     * @param node the node.
+     * @param bits the code of node, the bit nearest the root lowest.
+     * @param length how many bits the code of node has.
+     */
+    void assignCodes(HCNode* node, unsigned long long bits,
+            unsigned int length);
+
 public:
     const static int TABLE_SIZE = 65536;
+    /** Most bits decode() looks up at once. Its table has an entry for
+     * each value of them, so keep it small, a ContextHCTree has hundreds.
+     */
+    const static unsigned int DECODE_BITS = 10;
+    /** Deepest trie buildFromEncoding takes. No code is that long, and
+     * it keeps the recursive walks of a trie from garbage shallow.
+     */
+    const static unsigned int MAX_DEPTH = 64;
 
-    explicit HCTree() : root(nullptr) {
-        leaves = vector<HCNode*>(TABLE_SIZE, (HCNode*) nullptr);
-    }
+    /** Header flag: tree was built from a sample of the file. */
+    const static byte SAMPLED = 1;
+    /** Header flag: no tree, symbols coded with an AdaptiveHCTree. */
+    const static byte ADAPTIVE = 2;
+
+    /** Header flag: symbols coded with a ContextHCTree. */
+    const static byte ORDER1 = 4;
+    /** Header flag: a CRC32C follows each block of coded symbols. */
+    const static byte CHECKSUM = 8;
+
+    /** Constructor, an empty tree until we build. */
+    explicit HCTree()
+        : root(nullptr), hasEscape(false), escape(0), decodeBits(0) { }
 
     /** Destructor */
     ~HCTree();
 
+    /** Empty the tree so it can be built again. */
+    void reset();
+
+    /** Get the root, for walking the trie outside of decode().
+     * @return the root, or nullptr if nothing was built.
+     */
+    const HCNode* getRoot() const {
+        return root;
+    }
+
     /** Use the Huffman algorithm to build a Huffman coding trie.
      * PRECONDITION: freqs is a vector of ints, such that freqs[i] is
      * the frequency of occurrence of byte i in the message.
      * POSTCONDITION: root points to the root of the trie,
-     * and leaves[i] points to the leaf node containing byte i.
+     * and codes[i] holds the code of each symbol i in it.
      * @param freqs vector of ascii values and their frequency.
      */
-    void build(unordered_map<twoBytes, int> freqs);
+    void build(const unordered_map<twoBytes, int>& freqs);
 
     /** Use our encoding to build a Huffman coding trie.
-     * PRECONDITION: a file was properly encoded.
      * @param in our input stream for bits.
+     * @return false if the input ran out or the trie is deeper than
+     *     MAX_DEPTH, so it was not properly encoded.
+     */
+    bool buildFromEncoding(BitInputStream& in);
+
+    /** Code symbols that are not in the tree as this symbol's code
+     * followed by the raw symbol.
+     * PRECONDITION: escape is not in the frequencies given to build().
+     * @param symbol the escape symbol.
      */
-    void buildFromEncoding(BitInputStream& in);
+    void setEscape(twoBytes symbol);
 
     /** Encode this tree with pre-order traversal.
      * PRECONDITION: build() has been called, to create the coding
-     * tree, and initialize root pointer and leaves vector.
+     * tree, and initialize root pointer and codes.
      * @param out our input stream for bits.
      * @param numCharacters how many total characters there are.
      * @param numUniqueChars how many different ascii values there are.
+     * @param flags header flags, such as SAMPLED.
      */
     void writeHeader(BitOutputStream& out, unsigned int numCharacters,
-            unsigned int numUniqueChars) const;
+            unsigned int numUniqueChars, byte flags) const;
+
+    /** Encode just this tree: a symbol if it is the only one,
+     * else the pre-order traversal.
+     * PRECONDITION: build() has been called with at least one symbol.
+     * @param out our output stream for bits.
+     */
+    void writeTree(BitOutputStream& out) const;
+
+    /** Build a Huffman coding trie written by writeTree.
+     * @param in our input stream for bits.
+     * @return false if what was read is not a trie writeTree wrote.
+     */
+    bool readTree(BitInputStream& in);
 
     /** Helper for writeHeader.
      * @param out our input stream for bits.
@@ -92,11 +187,23 @@ public:
     /** Write to the given BitOutputStream.
      *  the sequence of bits coding the given symbol.
      *  PRECONDITION: build() has been called, to create the coding
-     *  tree, and initialize root pointer and leaves vector.
+     *  tree, and initialize root pointer and codes.
      *  @param symbol 8 bits to be encoded.
      *  @param out our output stream.
      */
-    void encode(twoBytes symbol, BitOutputStream& out) const;
+    ALWAYS_INLINE void encode(twoBytes symbol, BitOutputStream& out) const {
+        auto found = codes.find(symbol);
+        // Symbol not in the tree, or the escape itself: write the escape code
+        // and the raw symbol, as decode reads raw bits after every escape.
+        if (hasEscape && (symbol == escape || found == codes.end())) {
+            const Code& code = codes.at(escape);
+            out.writeBits(code.bits, code.length);
+            out.writeShort(symbol);
+            return;
+        }
+        const Code& code = found->second;
+        out.writeBits(code.bits, code.length);
+    }
 
     /** Make sure we get the last byte in.
      * @param out our input stream for bits.
@@ -105,11 +212,37 @@ public:
 
     /** Return symbol coded in the next sequence of bits from the stream.
      *  PRECONDITION: build() has been called, to create the coding
-     *  tree, and initialize root pointer and leaves vector.
+     *  tree, and initialize root pointer and codes.
      *  @param in our input stream for bits.
      *  @return symbol of the 8 bits read.
      */
-    unsigned short decode(BitInputStream& in) const;
+    ALWAYS_INLINE unsigned short decode(BitInputStream& in) const {
+        int nextBit;
+        if (root == nullptr) { // Empty file case.
+            return 0;
+        }
+        // Else we have an ordinary file. Most codes are found in one look up.
+        const HCNode* curr = root;
+        if (decodeBits > 0) {
+            const DecodeStep& step = decodeTable[in.peekBits(decodeBits)];
+            in.skipBits(step.length);
+            curr = step.node;
+        }
+        // Codes longer than that go on a bit at a time.
+        while (curr->c0 != nullptr && curr->c1 != nullptr) { // Not a leaf:
+            nextBit = in.readBit();
+            if (nextBit == 0) {
+                curr = curr->c0;
+            } else {
+                curr = curr->c1;
+            }
+        }
+        // Escaped symbol follows in raw.
+        if (hasEscape && curr->symbol == escape) {
+            return in.readShort();
+        }
+        return curr->symbol;
+    }
 
 };
 
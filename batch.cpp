@@ -0,0 +1,160 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Main runner to compress many files in one process.
+ * Worker threads each keep one Compressor and take the next file to do
+ * until there are none left, then every result is reported.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <cstdlib>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "Compressor.hpp"
+
+/** A file to compress and where to write it.
+ * @infile name of the file to compress.
+ * @outfile name of the file to write.
+ */
+struct Job {
+    string infile;
+    string outfile;
+};
+
+/**
+ * Get every regular file in a directory, compressed into another one
+ * under the same name.
+ * @param indir directory of files to compress.
+ * @param outdir directory to write to.
+ * @param jobs where to add the files.
+ * @return false if indir could not be read.
+ */
+bool listDirectory(const string& indir, const string& outdir,
+        vector<Job>& jobs) {
+    DIR* dir = opendir(indir.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        string infile = indir + "/" + entry->d_name;
+        struct stat info;
+        if (stat(infile.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+            jobs.push_back({infile, outdir + "/" + entry->d_name});
+        }
+    }
+    closedir(dir);
+    return true;
+}
+
+/**
+ * Get the files in a manifest, one "<infile> <outfile>" pair per line.
+ * Blank lines are skipped, any other line must be exactly one pair.
+ * @param manifest name of the manifest.
+ * @param jobs where to add the files.
+ * @param error set to why not, if the manifest could not be read.
+ * @return false if the manifest could not be read or has a bad line.
+ */
+bool readManifest(const string& manifest, vector<Job>& jobs,
+        string& error) {
+    ifstream input(manifest);
+    if (!input.is_open()) {
+        error = "cannot open " + manifest;
+        return false;
+    }
+    string line;
+    for (int number = 1; getline(input, line); number++) {
+        istringstream fields(line);
+        Job job;
+        string extra;
+        if (!(fields >> job.infile)) {
+            continue;
+        }
+        if (!(fields >> job.outfile) || fields >> extra) {
+            error = manifest + " line " + to_string(number)
+                    + ": expected <infile> <outfile>";
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+/**
+ * Compresses every file in a manifest or directory.
+ * @param argc number of arguments
+ * @param argv a manifest, or a directory and an output directory.
+ *     Leading options: -j <threads> sets how many workers to use,
+ *     the rest pick the engine as for ./compress.
+ * @return failure if wrong arguments or any file failed. Success otherwise.
+ */
+int main(int argc, char** argv) {
+    byte flags = 0;
+    unsigned int numThreads = thread::hardware_concurrency();
+    int arg = 1;
+    for (; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            numThreads = atoi(argv[++arg]);
+        } else if (!Compressor::parseOption(argv[arg], flags)) {
+            break;
+        }
+    }
+    vector<Job> jobs;
+    bool listed = false;
+    string error;
+    if (argc - arg == 1) {
+        listed = readManifest(argv[arg], jobs, error);
+    } else if (argc - arg == 2) {
+        listed = listDirectory(argv[arg], argv[arg + 1], jobs);
+    }
+    // A manifest we could open but not make sense of.
+    if (!error.empty() && Compressor::validFlags(flags)) {
+        cout << error << endl;
+        return EXIT_FAILURE;
+    }
+    if (!listed || !Compressor::validFlags(flags)) {
+        cout << "Invalid arguments" << endl <<
+             "Usage: ./batch [-s | -a | -o] [-c] [-j <threads>] "
+             "<manifest filename> | <indir> <outdir>." << endl;
+        return EXIT_FAILURE;
+    }
+    numThreads = max(1u, min(numThreads, (unsigned int) jobs.size()));
+    // Each worker takes the next job, so fast files never wait on slow ones.
+    vector<CompressResult> results(jobs.size());
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < numThreads; i++) {
+        workers.push_back(thread([&]() {
+            Compressor compressor;
+            for (size_t job = next++; job < jobs.size(); job = next++) {
+                results[job] = compressor.compress(jobs[job].infile,
+                        jobs[job].outfile, flags);
+            }
+        }));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    // Report every file, then the totals.
+    unsigned int numFailed = 0;
+    unsigned long inBytes = 0;
+    unsigned long outBytes = 0;
+    for (size_t job = 0; job < jobs.size(); job++) {
+        if (results[job].ok) {
+            cout << jobs[job].infile << ": " << results[job].inBytes
+                 << " -> " << results[job].outBytes << " bytes" << endl;
+            inBytes += results[job].inBytes;
+            outBytes += results[job].outBytes;
+        } else {
+            cout << jobs[job].infile << ": " << results[job].error << endl;
+            numFailed++;
+        }
+    }
+    cout << jobs.size() - numFailed << " of " << jobs.size()
+         << " files compressed, " << inBytes << " -> " << outBytes
+         << " bytes" << endl;
+    return numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
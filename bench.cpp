@@ -0,0 +1,100 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Benchmark runner comparing the static, sampled, adaptive and order-1
+ * engines, and static with checksums.
+ * Codes a file in memory with the Compressor and Decompressor each engine
+ * ships in, and reports size and speed.
+ */
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include "Decompressor.hpp"
+
+/**
+ * Time Compressor and Decompressor on data in memory with one set of
+ * header flags, and print the results.
+ * @param name name of the engine.
+ * @param data the bytes to be coded.
+ * @param flags header flags picking the engine, as for ./compress.
+ * @param compressor the Compressor to time.
+ * @param decompressor the Decompressor to time.
+ * @return false if either failed or the data did not survive the round
+ *     trip.
+ */
+bool run(const string& name, const string& data, byte flags,
+        Compressor& compressor, Decompressor& decompressor) {
+    typedef chrono::steady_clock clock;
+    istringstream in(data);
+    ostringstream compressed;
+    auto start = clock::now();
+    CompressResult encoded = compressor.compress(in, compressed, flags);
+    auto encodedAt = clock::now();
+    istringstream coded(compressed.str());
+    ostringstream out;
+    auto decodeStart = clock::now();
+    CompressResult decoded = decompressor.uncompress(coded, out);
+    auto end = clock::now();
+    if (!encoded.ok || !decoded.ok) {
+        cout << name << ": " << encoded.error << decoded.error << endl;
+        return false;
+    }
+    double encodeSecs = chrono::duration<double>(encodedAt - start).count();
+    double decodeSecs = chrono::duration<double>(end - decodeStart).count();
+    double megabytes = data.size() / 1e6;
+    cout << name << ": " << compressed.str().size() << " bytes, encode "
+         << megabytes / encodeSecs << " MB/s, decode "
+         << megabytes / decodeSecs << " MB/s" << endl;
+    return out.str() == data;
+}
+
+/**
+ * Benchmarks each engine on a file.
+ * @param argc number of arguments
+ * @param argv one argument, file name to be coded.
+ *     Leading option: --kernel <name> codes with that kernel instead of
+ *     the best this CPU runs.
+ * @return failure if wrong arguments or a round trip failed.
+ */
+int main(int argc, char** argv) {
+    const int NUM_ARGS = 1;
+    int arg = 1;
+    bool selected = true;
+    if (arg + 1 < argc && strcmp(argv[arg], "--kernel") == 0) {
+        selected = BitKernel::select(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg != NUM_ARGS || !selected) {
+        cout << "Invalid arguments" << endl <<
+             "Usage: ./bench [--kernel <" << BitKernel::names()
+             << ">] <infile filename>." << endl;
+        return EXIT_FAILURE;
+    }
+    ifstream input(argv[arg], ios_base::binary);
+    stringstream contents;
+    contents << input.rdbuf();
+    string data = contents.str();
+    if (data.empty()) {
+        cout << "Nothing to benchmark in an empty file." << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "input: " << data.size() << " bytes, kernel "
+         << BitKernel::current().name << endl;
+    Compressor compressor;
+    Decompressor decompressor;
+    bool ok = run("static", data, 0, compressor, decompressor);
+    ok = run("sampled", data, HCTree::SAMPLED, compressor, decompressor)
+            && ok;
+    ok = run("adaptive", data, HCTree::ADAPTIVE, compressor, decompressor)
+            && ok;
+    ok = run("order-1", data, HCTree::ORDER1, compressor, decompressor)
+            && ok;
+    // Static again with checksums, to time the CRC32C of each kernel.
+    ok = run("checked", data, HCTree::CHECKSUM, compressor, decompressor)
+            && ok;
+    if (!ok) {
+        cout << "Round trip failed." << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+#!/bin/sh
+# Christopher Yeh
+# cyeh@ucsd.edu
+# Round trips files that have broken our engines before through every
+# mode of ./compress and ./uncompress, then checks ./search and that
+# changed files are caught. Run with make check.
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+failed=0
+
+# The escape of a sampled tree is the smallest symbol missing from the
+# sample. Here that is \0\0, which the sample skips over but the file has.
+yes ab | tr -d '\n' | head -c 8000000 > "$dir/ab"
+{ head -c 100000 "$dir/ab"; printf '\0\0'; tail -c +100003 "$dir/ab"; } \
+    > "$dir/escape"
+# High entropy, the adaptive tree escapes new symbols all the time.
+head -c 300001 /dev/urandom > "$dir/random"
+printf 'x' > "$dir/one"
+: > "$dir/empty"
+
+for file in escape random one empty; do
+    for options in "" "-s" "-a" "-o" "-c" "-s -c" "-a -c" "-o -c"; do
+        if ! ./compress $options "$dir/$file" "$dir/out.z" > /dev/null \
+                || ! ./uncompress "$dir/out.z" "$dir/out" > /dev/null \
+                || ! cmp -s "$dir/$file" "$dir/out"; then
+            echo "FAIL: $file with options '$options'"
+            failed=1
+        fi
+    done
+done
+
+# search must find what grep finds, in every mode it reads. Blocks end
+# every 64KB, the needles sit across the first two ends, one at an odd
+# offset, and zebra is nowhere.
+yes 'the quick brown fox jumps over the lazy dog' | head -c 300000 \
+    > "$dir/fox"
+{ head -c 65530 "$dir/fox"; printf 'needle across'; head -c 65528 "$dir/fox"
+    printf 'odd needle'; head -c 100000 "$dir/fox"; } > "$dir/text"
+for options in "" "-s" "-c" "-s -c"; do
+    ./compress $options "$dir/text" "$dir/out.z" > /dev/null
+    for pattern in "needle across" "odd needle" "quick" "x jumps o" \
+            "zebra"; do
+        ./search "$pattern" "$dir/out.z" > "$dir/found"
+        grep -obaF "$pattern" "$dir/text" | cut -d: -f1 > "$dir/expected"
+        if ! cmp -s "$dir/found" "$dir/expected"; then
+            echo "FAIL: search for '$pattern' with options '$options'"
+            failed=1
+        fi
+    done
+done
+
+# Flip the bits of mask in the byte at an offset of a file.
+flip() {
+    value=$(od -An -tu1 -j "$2" -N1 "$1")
+    printf "$(printf '\\%03o' $((value ^ $3)))" \
+        | dd of="$1" bs=1 seek="$2" conv=notrunc 2> /dev/null
+}
+
+# A checked file that was changed must fail and leave no output, whether
+# a code, the count or the flag turning checks on was hit.
+for options in "-c" "-s -c" "-a -c" "-o -c"; do
+    for change in "150000 1" "0 1" "4 8"; do
+        ./compress $options "$dir/random" "$dir/out.z" > /dev/null
+        flip "$dir/out.z" $change
+        rm -f "$dir/out"
+        if ./uncompress "$dir/out.z" "$dir/out" > /dev/null \
+                || [ -e "$dir/out" ]; then
+            echo "FAIL: changed byte and mask $change with options '$options'"
+            failed=1
+        fi
+    done
+done
+
+if [ $failed -eq 0 ]; then
+    echo "All checks passed."
+fi
+exit $failed
@@ -0,0 +1,63 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Main runner to serve compress and uncompress requests over a Unix
+ * domain socket until interrupted.
+ */
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include "HCDaemon.hpp"
+
+/**
+ * Runs the daemon until SIGINT or SIGTERM.
+ * @param argc number of arguments
+ * @param argv one argument, where to bind the socket.
+ *     Leading options: -j <threads> sets how many workers to use,
+ *     --kernel <name> codes with that kernel instead of the best this
+ *     CPU runs.
+ * @return failure if wrong arguments or the socket could not be bound.
+ *     Success otherwise.
+ */
+int main(int argc, char** argv) {
+    unsigned int numThreads = thread::hardware_concurrency();
+    bool selected = true;
+    int arg = 1;
+    for (; arg + 1 < argc; arg += 2) {
+        if (strcmp(argv[arg], "-j") == 0) {
+            numThreads = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--kernel") == 0) {
+            selected = BitKernel::select(argv[arg + 1]) && selected;
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 1 || !selected) {
+        cout << "Invalid arguments" << endl <<
+             "Usage: ./daemon [-j <threads>] [--kernel <"
+             << BitKernel::names() << ">] <socket path>." << endl;
+        return EXIT_FAILURE;
+    }
+    // Every thread started from here on leaves the stop signals to
+    // sigwait, so none is interrupted in the middle of a request.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    HCDaemon daemon(argv[arg], numThreads);
+    string error;
+    if (!daemon.start(error)) {
+        cout << error << endl;
+        return EXIT_FAILURE;
+    }
+    thread stopper([&]() {
+        int signal;
+        sigwait(&signals, &signal);
+        daemon.stop();
+    });
+    stopper.detach();
+    daemon.run();
+    return EXIT_SUCCESS;
+}
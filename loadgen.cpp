@@ -0,0 +1,151 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Main runner to load test a running daemon.
+ * Each client thread compresses slices of a sample file and uncompresses
+ * the results, timing every request, then latency percentiles are reported.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+#include "Compressor.hpp"
+#include "HCClient.hpp"
+
+typedef chrono::steady_clock timer;
+
+/**
+ * Report how many requests there were and how long they took.
+ * @param name what kind of request.
+ * @param micros latency of each request in microseconds, gets sorted.
+ * @param seconds how long the whole run took.
+ */
+void report(const string& name, vector<double>& micros, double seconds) {
+    if (micros.empty()) {
+        return;
+    }
+    sort(micros.begin(), micros.end());
+    // Nearest rank: the smallest latency at least p of requests are under.
+    auto percentile = [&](double p) {
+        size_t rank = (size_t) ceil(p * micros.size());
+        return micros[max(rank, (size_t) 1) - 1];
+    };
+    cout << fixed << setprecision(1) << name << ": " << micros.size()
+         << " requests, " << micros.size() / seconds << " per second, "
+         << "p50 " << percentile(0.50) << " us, p99 " << percentile(0.99)
+         << " us, max " << micros.back() << " us" << endl;
+}
+
+/**
+ * Load tests a daemon.
+ * @param argc number of arguments
+ * @param argv two arguments, the daemon's socket and a sample file.
+ *     Leading options: -n <clients> sets how many connections to open,
+ *     -r <requests> how many each sends, -b <bytes> how big each
+ *     payload is, the rest pick the engine as for ./compress.
+ * @return failure if wrong arguments or any request failed or did not
+ *     round trip. Success otherwise.
+ */
+int main(int argc, char** argv) {
+    byte flags = 0;
+    unsigned int numClients = 4;
+    unsigned int numRequests = 1000;
+    unsigned int payloadBytes = 4096;
+    int arg = 1;
+    for (; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            numClients = max(1, atoi(argv[++arg]));
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            numRequests = max(1, atoi(argv[++arg]));
+        } else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+            payloadBytes = max(1, atoi(argv[++arg]));
+        } else if (!Compressor::parseOption(argv[arg], flags)) {
+            break;
+        }
+    }
+    if (argc - arg != 2 || !Compressor::validFlags(flags)) {
+        cout << "Invalid arguments" << endl <<
+             "Usage: ./loadgen [-s | -a | -o] [-c] [-n <clients>] "
+             "[-r <requests>] [-b <bytes>] <socket path> "
+             "<sample filename>." << endl;
+        return EXIT_FAILURE;
+    }
+    const string SOCKET = argv[arg];
+    ifstream input(argv[arg + 1], ios_base::binary);
+    string sample((istreambuf_iterator<char>(input)),
+            istreambuf_iterator<char>());
+    if (sample.empty()) {
+        cout << "cannot read " << argv[arg + 1] << endl;
+        return EXIT_FAILURE;
+    }
+    payloadBytes = min(payloadBytes, (unsigned int) sample.size());
+    // Each client keeps its own latencies, merged once all are done.
+    vector<vector<double>> compressMicros(numClients);
+    vector<vector<double>> uncompressMicros(numClients);
+    vector<string> errors(numClients);
+    vector<thread> clients;
+    auto start = timer::now();
+    for (unsigned int i = 0; i < numClients; i++) {
+        clients.push_back(thread([&, i]() {
+            HCClient client;
+            if (!client.connect(SOCKET)) {
+                errors[i] = "cannot connect to " + SOCKET;
+                return;
+            }
+            string compressed;
+            string uncompressed;
+            // Clients start at different places so they send different data.
+            size_t offset = (i * sample.size() / numClients);
+            for (unsigned int r = 0; r < numRequests; r++) {
+                offset = (offset + payloadBytes) % sample.size();
+                offset = min(offset, sample.size() - payloadBytes);
+                string payload = sample.substr(offset, payloadBytes);
+                auto sent = timer::now();
+                if (!client.compress(payload, flags, compressed)) {
+                    errors[i] = compressed;
+                    return;
+                }
+                auto compressedAt = timer::now();
+                if (!client.uncompress(compressed, uncompressed)) {
+                    errors[i] = uncompressed;
+                    return;
+                }
+                auto uncompressedAt = timer::now();
+                if (uncompressed != payload) {
+                    errors[i] = "round trip did not match";
+                    return;
+                }
+                compressMicros[i].push_back(chrono::duration<double,
+                        micro>(compressedAt - sent).count());
+                uncompressMicros[i].push_back(chrono::duration<double,
+                        micro>(uncompressedAt - compressedAt).count());
+            }
+        }));
+    }
+    for (thread& client : clients) {
+        client.join();
+    }
+    double seconds = chrono::duration<double>(timer::now() - start).count();
+    bool failed = false;
+    vector<double> allCompress;
+    vector<double> allUncompress;
+    for (unsigned int i = 0; i < numClients; i++) {
+        if (!errors[i].empty()) {
+            cout << "client " << i << ": " << errors[i] << endl;
+            failed = true;
+        }
+        allCompress.insert(allCompress.end(), compressMicros[i].begin(),
+                compressMicros[i].end());
+        allUncompress.insert(allUncompress.end(),
+                uncompressMicros[i].begin(), uncompressMicros[i].end());
+    }
+    cout << numClients << " clients, " << payloadBytes << " byte payloads"
+         << endl;
+    report("compress", allCompress, seconds);
+    report("uncompress", allUncompress, seconds);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
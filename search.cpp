@@ -0,0 +1,67 @@
+/**
+ * Christopher Yeh
+ * cyeh@ucsd.edu
+ * Main runner to search a compressed file without uncompressing it.
+ * Compile and run with proper arguments.
+ */
+#include <sstream>
+#include "CodeSearch.hpp"
+
+/**
+ * Prints the offset of every match of a pattern in a compressed file.
+ * @param argc number of arguments
+ * @param argv two arguments, the pattern and compressed file name.
+ * @return failure if wrong arguments, no match or a file we cannot
+ *     search. Success otherwise.
+ */
+int main(int argc, char** argv) {
+    const int NUM_ARGS = 3;
+    if (argc != NUM_ARGS || argv[1][0] == '\0') {
+        cout << "Invalid number of arguments" << endl <<
+             "Usage: ./search <pattern> <infile filename>." << endl;
+        return EXIT_FAILURE;
+    }
+    const string PATTERN = argv[1];
+    ifstream input(argv[2], ios_base::binary);
+    stringstream contents;
+    contents << input.rdbuf();
+    const string data = contents.str();
+    // Empty file, nothing to find.
+    if (data.empty()) {
+        return EXIT_FAILURE;
+    }
+    stringstream stream(data);
+    BitInputStream bitIn = BitInputStream(stream);
+    unsigned int numCharacters = bitIn.readInt();
+    byte flags = bitIn.readByte();
+    unsigned long start = (sizeof(int) + 1) * CHAR_BIT;
+    if (flags & (HCTree::ADAPTIVE | HCTree::ORDER1)) {
+        cout << "Only files coded with one tree can be searched." << endl;
+        return EXIT_FAILURE;
+    }
+    HCTree ht;
+    bool hasEscape = false;
+    twoBytes escape = 0;
+    // Sampled trees may escape symbols missing from the sample.
+    if (flags & HCTree::SAMPLED) {
+        hasEscape = bitIn.readBit();
+        start++;
+        if (hasEscape) {
+            escape = bitIn.readShort();
+            ht.setEscape(escape);
+            start += sizeof(twoBytes) * CHAR_BIT;
+        }
+    }
+    if (!ht.readTree(bitIn)) {
+        cout << "Not a file ./compress wrote." << endl;
+        return EXIT_FAILURE;
+    }
+    CodeSearch search(data, ht, hasEscape, escape, flags & HCTree::CHECKSUM);
+    start += search.treeBits();
+    vector<unsigned long> offsets = search.find(PATTERN, start,
+            numCharacters);
+    for (unsigned long offset : offsets) {
+        cout << offset << endl;
+    }
+    return offsets.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -4,13 +4,14 @@
  * Main runner to uncompress a file with a huffman trie.
  * Compile and run with proper arguments.
  */
-#include "HCTree.hpp"
+#include "Decompressor.hpp"
 
 /**
  * Decodes our compressed file.
  * @param argc number of arguments
  * @param argv two arguments, compressed file name and output file name.
- * @return failure if wrong number of arguments. Success otherwise.
+ * @return failure if wrong number of arguments or a checksum did not
+ *     match. Success otherwise.
  */
 int main(int argc, char** argv) {
 // Check for appropriate arguments. Does not account for invalid files.
@@ -21,50 +22,11 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
     // Error "checking" done. Proceed with program.
-    const string INFILE = argv[1];
-    const string OUTFILE = argv[2];
-    ifstream input;
-    ofstream output;
-    input.open(INFILE, ios_base::binary);
-    output.open(OUTFILE, ios_base::trunc);
-    // If file is empty, don't write anything.
-    input.seekg(0, ios::end);
-    if (input.tellg() == 0) {
-        return EXIT_SUCCESS;
-    }
-    input.clear();
-    input.seekg(0);
-    // Get the number of characters for out output.
-    BitInputStream bitIn = BitInputStream(input);
-    unsigned int numCharacters = bitIn.readInt();
-    unsigned int numUniqueChars = bitIn.readBit();
-    unsigned short nextBytes;
-    // Single character cases.
-    if (numUniqueChars == 1) {
-        unsigned char nextByte = bitIn.readByte();
-        for (int i = 0; i < numCharacters; i++) {
-            output << nextByte;
-        }
-        return EXIT_SUCCESS;
-    }
-    // Build our tree from encoding.
-    HCTree* ht = new HCTree();
-    ht->buildFromEncoding(bitIn);
-    // Output to our file. Deconstruct and return success.
-    int count = 0;
-    while (true) {
-        nextBytes = ht->decode(bitIn);
-        unsigned char byte1 = nextBytes;
-        count++;
-        if (count <= numCharacters) {
-            output << byte1;
-        } else break;
-        unsigned char byte2 = nextBytes >> 8;
-        count++;
-        if (count <= numCharacters) {
-            output << byte2;
-        } else break;
+    Decompressor decompressor;
+    CompressResult result = decompressor.uncompress(argv[1], argv[2]);
+    if (!result.ok) {
+        cout << result.error << endl;
+        return EXIT_FAILURE;
     }
-    delete ht;
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}